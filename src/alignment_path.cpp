@@ -182,6 +182,16 @@ ostream & operator<<(ostream & os, const vector<AlignmentPath> & align_path) {
     return os;
 }
 
+bool operator==(const AlignmentPathSpan & lhs, const AlignmentPathSpan & rhs) { 
+
+    return (lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin()));
+}
+
+bool operator!=(const AlignmentPathSpan & lhs, const AlignmentPathSpan & rhs) { 
+
+    return !(lhs == rhs);
+}
+
 
 InternalAlignment::InternalAlignment() {
 
@@ -41,12 +41,43 @@ bool operator<(const AlignmentPath & lhs, const AlignmentPath & rhs);
 ostream & operator<<(ostream & os, const AlignmentPath & align_path);
 ostream & operator<<(ostream & os, const vector<AlignmentPath> & align_paths);
 
+
+// Non-owning view of a contiguous sequence of alignment paths.
+class AlignmentPathSpan {
+
+    public: 
+
+        AlignmentPathSpan() : begin_(nullptr), size_(0) {}
+        AlignmentPathSpan(const AlignmentPath * begin_in, const uint32_t size_in) : begin_(begin_in), size_(size_in) {}
+        AlignmentPathSpan(const vector<AlignmentPath> & align_paths) : begin_(align_paths.data()), size_(align_paths.size()) {}
+
+        const AlignmentPath * begin() const { return begin_; }
+        const AlignmentPath * end() const { return begin_ + size_; }
+
+        uint32_t size() const { return size_; }
+        bool empty() const { return (size_ == 0); }
+
+        const AlignmentPath & front() const { assert(size_ > 0); return *begin_; }
+        const AlignmentPath & back() const { assert(size_ > 0); return *(begin_ + size_ - 1); }
+
+        const AlignmentPath & at(const uint32_t idx) const { assert(idx < size_); return *(begin_ + idx); }
+        const AlignmentPath & operator[](const uint32_t idx) const { return *(begin_ + idx); }
+
+    private:
+
+        const AlignmentPath * begin_;
+        uint32_t size_;
+};
+
+bool operator==(const AlignmentPathSpan & lhs, const AlignmentPathSpan & rhs);
+bool operator!=(const AlignmentPathSpan & lhs, const AlignmentPathSpan & rhs);
+
 namespace std {
 
     template<> 
-    struct hash<vector<AlignmentPath> >
+    struct hash<AlignmentPathSpan>
     {
-        size_t operator()(const vector<AlignmentPath> & align_paths) const
+        size_t operator()(const AlignmentPathSpan & align_paths) const
         {
             size_t seed = 0;
 
@@ -2,18 +2,61 @@
 #include "alignment_path_finder.hpp"
 
 #include <assert.h>
+#include <omp.h>
 #include <stack>
 
 #include "utils.hpp"
+#include "read_stats.hpp"
 
 //#define debug
 
 static const int32_t max_noise_score_diff = (Utils::default_match + Utils::default_mismatch) * 2;
 
+// Number of entries (log2) in each per-thread GBWT search cache.
+static const uint32_t search_cache_size_log2 = 14;
+
 
 template<class AlignmentType>
-AlignmentPathFinder<AlignmentType>::AlignmentPathFinder(const PathsIndex & paths_index_in, const string library_type_in, const bool score_not_qual_in, const bool use_allelic_mapq_in, const uint32_t max_pair_frag_length_in, const uint32_t max_partial_offset_in, const bool est_missing_noise_prob_in, const int32_t max_score_diff_in, const double min_best_score_filter_in) : paths_index(paths_index_in), library_type(library_type_in), score_not_qual(score_not_qual_in), use_allelic_mapq(use_allelic_mapq_in), max_pair_frag_length(max_pair_frag_length_in), max_partial_offset(max_partial_offset_in), est_missing_noise_prob(est_missing_noise_prob_in), max_score_diff(max_score_diff_in), min_best_score_filter(min_best_score_filter_in) {}
+AlignmentPathFinder<AlignmentType>::AlignmentPathFinder(const PathsIndex & paths_index_in, const uint32_t num_threads, const string library_type_in, const bool score_not_qual_in, const bool use_allelic_mapq_in, const uint32_t max_pair_frag_length_in, const uint32_t max_partial_offset_in, const bool est_missing_noise_prob_in, const int32_t max_score_diff_in, const double min_best_score_filter_in) : paths_index(paths_index_in), search_forward_strand(library_type_in == "fr" || library_type_in == "unstranded"), search_reverse_strand(library_type_in == "rf" || (library_type_in == "unstranded" && !paths_index_in.bidirectional())), score_not_qual(score_not_qual_in), use_allelic_mapq(use_allelic_mapq_in), max_pair_frag_length(max_pair_frag_length_in), max_partial_offset(max_partial_offset_in), est_missing_noise_prob(est_missing_noise_prob_in), max_score_diff(max_score_diff_in), min_best_score_filter(min_best_score_filter_in), search_caches(num_threads, GBWTSearchCache(search_cache_size_log2)) {
+
+    assert(num_threads > 0);
+    assert(library_type_in == "fr" || library_type_in == "rf" || library_type_in == "unstranded");
+}
         
+template<class AlignmentType>
+GBWTSearchCache * AlignmentPathFinder<AlignmentType>::threadSearchCache() const {
+
+    // The finder must not be used by more threads than it was created for.
+    assert(omp_get_thread_num() < static_cast<int>(search_caches.size()));
+    return &(search_caches.at(omp_get_thread_num()));
+}
+
+template<class AlignmentType>
+uint64_t AlignmentPathFinder<AlignmentType>::searchCacheLookups() const {
+
+    uint64_t num_lookups = 0;
+
+    for (auto & search_cache: search_caches) {
+
+        num_lookups += search_cache.lookups();
+    }
+
+    return num_lookups;
+}
+
+template<class AlignmentType>
+uint64_t AlignmentPathFinder<AlignmentType>::searchCacheHits() const {
+
+    uint64_t num_hits = 0;
+
+    for (auto & search_cache: search_caches) {
+
+        num_hits += search_cache.hits();
+    }
+
+    return num_hits;
+}
+
 template<class AlignmentType>
 bool AlignmentPathFinder<AlignmentType>::alignmentHasPath(const vg::Alignment & alignment) const {
 
@@ -135,29 +178,25 @@ vector<AlignmentPath> AlignmentPathFinder<AlignmentType>::findAlignmentPaths(con
 
     vector<AlignmentSearchPath> align_search_paths;
 
-    function<size_t(const uint32_t)> node_length_func = [&](const uint32_t node_id) { return paths_index.nodeLength(node_id); };
-
-    if (library_type == "fr") {
+    function<int64_t(int64_t)> node_length_func = [&](const int64_t node_id) { return paths_index.nodeLength(node_id); };
 
-        findAlignmentSearchPaths(&align_search_paths, alignment);
+    // Reverse complemented alignments are written to a thread-local 
+    // alignment to reuse its allocated memory between reads.
+    thread_local AlignmentType alignment_rc;
 
-    } else if (library_type == "rf") {
+    if (search_forward_strand) {
 
-        AlignmentType alignment_rc = Utils::lazy_reverse_complement_alignment(alignment, node_length_func);
-        findAlignmentSearchPaths(&align_search_paths, alignment_rc);
-
-    } else {
-
-        assert(library_type == "unstranded");
         findAlignmentSearchPaths(&align_search_paths, alignment);
+    }
 
-        if (!paths_index.bidirectional()) {
+    if (search_reverse_strand) {
 
-            AlignmentType alignment_rc = Utils::lazy_reverse_complement_alignment(alignment, node_length_func);
-            findAlignmentSearchPaths(&align_search_paths, alignment_rc);
-        }  
+        Utils::lazy_reverse_complement_alignment(alignment, node_length_func, &alignment_rc);
+        findAlignmentSearchPaths(&align_search_paths, alignment_rc);
     }
 
+    ADD_READ_COST(num_search_paths, align_search_paths.size());
+
     auto align_paths = AlignmentPath::alignmentSearchPathsToAlignmentPaths(align_search_paths, isAlignmentDisconnected(alignment), mappingQuality(alignment));
 
 #ifdef debug
@@ -416,7 +455,7 @@ void AlignmentPathFinder<AlignmentType>::extendAlignmentSearchPath(AlignmentSear
 
             if (!align_search_path->gbwt_search.first.empty()) {
 
-                paths_index.extend(&(align_search_path->gbwt_search), cur_node);
+                paths_index.extend(&(align_search_path->gbwt_search), cur_node, threadSearchCache());
             }
         } 
     }
@@ -504,16 +543,24 @@ vector<AlignmentSearchPath> AlignmentPathFinder<AlignmentType>::extendAlignmentS
 template<class AlignmentType>
 void AlignmentPathFinder<AlignmentType>::extendAlignmentSearchPaths(vector<AlignmentSearchPath> * align_search_paths, const AlignmentSearchPath & init_align_search_path, const google::protobuf::RepeatedPtrField<vg::Subpath> & subpaths, const uint32_t start_subpath_idx, const string & quality, const uint32_t seq_length, spp::sparse_hash_map<pair<uint32_t, uint32_t>, int32_t> * internal_node_subpaths, int32_t * best_align_score, const bool has_right_bonus) const {
 
-    stack<pair<AlignmentSearchPath, uint32_t> > align_search_paths_stack;
-    align_search_paths_stack.emplace(init_align_search_path, start_subpath_idx);
+    // Search paths are moved onto and off the stack and only copied 
+    // when a path branches into multiple next subpaths.
+    vector<pair<AlignmentSearchPath, uint32_t> > align_search_paths_stack;
+    align_search_paths_stack.emplace_back(init_align_search_path, start_subpath_idx);
+
+    vector<AlignmentSearchPath> extended_align_search_paths;
+    vector<pair<int32_t, uint32_t> > next_score_indexes;
 
     // Perform depth-first alignment path extension.
     while (!align_search_paths_stack.empty()) {
 
-        vector<AlignmentSearchPath> extended_align_search_paths(1, align_search_paths_stack.top().first);
-        const uint32_t subpath_idx = align_search_paths_stack.top().second;
+        extended_align_search_paths.clear();
+        extended_align_search_paths.emplace_back(move(align_search_paths_stack.back().first));
+        
+        const uint32_t subpath_idx = align_search_paths_stack.back().second;
 
-        align_search_paths_stack.pop();
+        align_search_paths_stack.pop_back();
+        ADD_READ_COST(num_expanded_nodes, 1);
 
         const vg::Subpath & subpath = subpaths.Get(subpath_idx);
         AlignmentSearchPath * extended_align_search_path = &(extended_align_search_paths.front());
@@ -596,7 +643,7 @@ void AlignmentPathFinder<AlignmentType>::extendAlignmentSearchPaths(vector<Align
 
             if (subpath.next_size() > 0) {
 
-                vector<pair<int32_t, uint32_t> > next_score_indexes;
+                next_score_indexes.clear();
 
                 for (auto & next_subpath_idx: subpath.next()) {
 
@@ -605,11 +652,15 @@ void AlignmentPathFinder<AlignmentType>::extendAlignmentSearchPaths(vector<Align
 
                 sort(next_score_indexes.begin(), next_score_indexes.end());
 
-                for (auto & next_score_idx: next_score_indexes) {
+                for (size_t i = 0; i + 1 < next_score_indexes.size(); ++i) {
 
-                    align_search_paths_stack.emplace(align_search_path, next_score_idx.second);
+                    align_search_paths_stack.emplace_back(align_search_path, next_score_indexes.at(i).second);
                 }
 
+                // The last (highest scoring) next subpath is extended first 
+                // and can take over the current search path.
+                align_search_paths_stack.emplace_back(move(align_search_path), next_score_indexes.back().second);
+
             } else if (subpath.connection_size() == 0) {
 
                 *best_align_score = max(*best_align_score, align_search_path.scoreSum());
@@ -647,32 +698,27 @@ vector<AlignmentPath> AlignmentPathFinder<AlignmentType>::findPairedAlignmentPat
 
     vector<AlignmentSearchPath> paired_align_search_paths;
 
-    function<size_t(const uint32_t)> node_length_func = [&](const uint32_t node_id) { return paths_index.nodeLength(node_id); };
-    AlignmentType alignment_2_rc = Utils::lazy_reverse_complement_alignment(alignment_2, node_length_func);
-
-    if (library_type == "fr") {
-
-        findPairedAlignmentSearchPaths(&paired_align_search_paths, alignment_1, alignment_2_rc);
+    function<int64_t(int64_t)> node_length_func = [&](const int64_t node_id) { return paths_index.nodeLength(node_id); };
 
-    } else if (library_type == "rf") {
-
-        AlignmentType alignment_1_rc = Utils::lazy_reverse_complement_alignment(alignment_1, node_length_func);
-        findPairedAlignmentSearchPaths(&paired_align_search_paths, alignment_2, alignment_1_rc);
-
-    } else {
+    // Reverse complemented alignments are written to thread-local 
+    // alignments to reuse their allocated memory between read pairs.
+    thread_local AlignmentType alignment_1_rc;
+    thread_local AlignmentType alignment_2_rc;
 
-        assert(library_type == "unstranded");
+    if (search_forward_strand) {
 
-        AlignmentType alignment_2_rc = Utils::lazy_reverse_complement_alignment(alignment_2, node_length_func);
+        Utils::lazy_reverse_complement_alignment(alignment_2, node_length_func, &alignment_2_rc);
         findPairedAlignmentSearchPaths(&paired_align_search_paths, alignment_1, alignment_2_rc);
+    }
 
-        if (!paths_index.bidirectional()) {
+    if (search_reverse_strand) {
 
-            AlignmentType alignment_1_rc = Utils::lazy_reverse_complement_alignment(alignment_1, node_length_func);
-            findPairedAlignmentSearchPaths(&paired_align_search_paths, alignment_2, alignment_1_rc);
-        }
+        Utils::lazy_reverse_complement_alignment(alignment_1, node_length_func, &alignment_1_rc);
+        findPairedAlignmentSearchPaths(&paired_align_search_paths, alignment_2, alignment_1_rc);
     }
 
+    ADD_READ_COST(num_search_paths, paired_align_search_paths.size());
+
     auto paired_align_paths = AlignmentPath::alignmentSearchPathsToAlignmentPaths(paired_align_search_paths, isAlignmentDisconnected(alignment_1) || isAlignmentDisconnected(alignment_2), min(mappingQuality(alignment_1), mappingQuality(alignment_2)));
 
 #ifdef debug
@@ -844,6 +890,26 @@ void AlignmentPathFinder<AlignmentType>::findPairedAlignmentSearchPaths(vector<A
         }
     }
 
+    // Lower bounds on the distance to the end alignment start nodes. Only 
+    // nodes from which a start node is within the fragment limit are included.
+    // The map is reused by all read pairs of a thread and is only valid when 
+    // the predecessor index is used.
+    thread_local spp::sparse_hash_map<gbwt::node_type, uint32_t> end_search_paths_start_nodes_distances;
+
+    if (paths_index.hasPredecessorIndex()) {
+
+        vector<gbwt::node_type> end_search_paths_start_nodes;
+        end_search_paths_start_nodes.reserve(end_search_paths_start_nodes_index.size());
+
+        for (auto & end_search_paths_start_node: end_search_paths_start_nodes_index) {
+
+            end_search_paths_start_nodes.emplace_back(end_search_paths_start_node.first);
+        }
+
+        const int64_t max_start_nodes_distance = static_cast<int64_t>(max_pair_frag_length) - static_cast<int64_t>(end_alignment.sequence().size() - end_max_left_softclip_length);
+        paths_index.minTargetDistances(&end_search_paths_start_nodes_distances, end_search_paths_start_nodes, max(static_cast<int64_t>(0), max_start_nodes_distance));
+    }
+
     stack<pair<AlignmentSearchPath, bool> > paired_align_search_path_stack;
 
     double joint_start_align_score = numeric_limits<int32_t>::lowest();
@@ -926,6 +992,7 @@ void AlignmentPathFinder<AlignmentType>::findPairedAlignmentSearchPaths(vector<A
 
         const pair<AlignmentSearchPath, bool> cur_paired_align_search_path = paired_align_search_path_stack.top();
         paired_align_search_path_stack.pop();
+        ADD_READ_COST(num_expanded_nodes, 1);
    
         assert(!cur_paired_align_search_path.first.gbwt_search.first.empty());
         assert(cur_paired_align_search_path.first.path.back() == cur_paired_align_search_path.first.gbwt_search.first.node);
@@ -972,6 +1039,22 @@ void AlignmentPathFinder<AlignmentType>::findPairedAlignmentSearchPaths(vector<A
             continue;
         }
 
+        if (paths_index.hasPredecessorIndex()) {
+
+            auto end_search_paths_start_nodes_distances_it = end_search_paths_start_nodes_distances.find(cur_paired_align_search_path.first.path.back());
+
+            // End current extension if no end alignment start node can be reached within the fragment limit.
+            if (end_search_paths_start_nodes_distances_it == end_search_paths_start_nodes_distances.end()) {
+
+                continue;
+            }
+
+            if (cur_paired_align_search_path.first.fragmentLength() + end_search_paths_start_nodes_distances_it->second + end_alignment.sequence().size() - end_max_left_softclip_length > max_pair_frag_length) {
+
+                continue;
+            }
+        }
+
         auto out_edges = paths_index.edges(cur_paired_align_search_path.first.gbwt_search.first.node);
 
         // End current extension if no outgoing edges exist.
@@ -988,7 +1071,7 @@ void AlignmentPathFinder<AlignmentType>::findPairedAlignmentSearchPaths(vector<A
             if (out_edges_it->first != gbwt::ENDMARKER && out_edges_it->first != cur_paired_align_search_path.first.read_align_stats.back().internal_end_next_node) {
 
                 auto extended_gbwt_search = cur_paired_align_search_path.first.gbwt_search;
-                paths_index.extend(&extended_gbwt_search, out_edges_it->first);
+                paths_index.extend(&extended_gbwt_search, out_edges_it->first, threadSearchCache());
 
                 // Add new extension to queue if not empty (path found).
                 if (!extended_gbwt_search.first.empty()) { 
@@ -1136,7 +1219,7 @@ void AlignmentPathFinder<AlignmentType>::mergeAlignmentSearchPath(AlignmentSearc
     while (second_path_start_idx < second_align_search_path.path.size()) {
 
         main_align_search_path->path.emplace_back(second_align_search_path.path.at(second_path_start_idx));
-        paths_index.extend(&(main_align_search_path->gbwt_search), main_align_search_path->path.back());
+        paths_index.extend(&(main_align_search_path->gbwt_search), main_align_search_path->path.back(), threadSearchCache());
 
         if (main_align_search_path->gbwt_search.first.empty()) {
 
@@ -17,15 +17,22 @@ class AlignmentPathFinder {
 
     public: 
     
-       	AlignmentPathFinder(const PathsIndex & paths_index_in, const string library_type_in, const bool score_not_qual_in, const bool use_allelic_mapq_in, const uint32_t max_pair_frag_length_in, const uint32_t max_partial_offset_in, const bool est_missing_noise_prob_in, const int32_t max_score_diff_in, const double min_best_score_filter_in);
+       	AlignmentPathFinder(const PathsIndex & paths_index_in, const uint32_t num_threads, const string library_type_in, const bool score_not_qual_in, const bool use_allelic_mapq_in, const uint32_t max_pair_frag_length_in, const uint32_t max_partial_offset_in, const bool est_missing_noise_prob_in, const int32_t max_score_diff_in, const double min_best_score_filter_in);
 
 		vector<AlignmentPath> findAlignmentPaths(const AlignmentType & alignment) const;
 		vector<AlignmentPath> findPairedAlignmentPaths(const AlignmentType & alignment_1, const AlignmentType & alignment_2) const;
 
+		uint64_t searchCacheLookups() const;
+		uint64_t searchCacheHits() const;
+
 	private:
 
        	const PathsIndex & paths_index;
-       	const string library_type;
+
+       	// Strands searched for each read (or read pair) resolved from the 
+       	// library type and index once at construction.
+       	const bool search_forward_strand;
+       	const bool search_reverse_strand;
 
        	const bool score_not_qual;
        	const bool use_allelic_mapq;
@@ -37,6 +44,12 @@ class AlignmentPathFinder {
        	const int32_t max_score_diff;
        	const double min_best_score_filter;
 
+       	// GBWT search caches indexed by OpenMP thread number. The number 
+       	// of caches is the number of threads given to the constructor.
+       	mutable vector<GBWTSearchCache> search_caches;
+
+       	GBWTSearchCache * threadSearchCache() const;
+
 		bool alignmentHasPath(const vg::Alignment & alignment) const;
 		bool alignmentHasPath(const vg::MultipathAlignment & alignment) const;
 		
@@ -0,0 +1,219 @@
+
+#include "alignment_paths_cache.hpp"
+
+#include <assert.h>
+
+#include "utils.hpp"
+
+
+// Increase when the binary layout of the cache changes.
+static const uint64_t align_paths_cache_magic = 0x5250564741504943;
+static const uint32_t align_paths_cache_version = 2;
+
+template<typename T>
+static void writeValue(ostream & out, const T value) {
+
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template<typename T>
+static T readValue(istream & in) {
+
+    T value = T();
+    in.read(reinterpret_cast<char *>(&value), sizeof(value));
+
+    return value;
+}
+
+AlignmentPathsCache::AlignmentPathsCache(const PathsIndex & paths_index_in, const bool is_single_end_in, const bool is_long_reads_in, const string & library_type_in, const bool is_single_path_in, const bool score_not_qual_in, const bool use_allelic_mapq_in, const uint32_t max_partial_offset_in, const uint32_t max_score_diff_in, const double min_best_score_filter_in, const FragmentLengthDist & pre_frag_length_dist_in) : paths_index(paths_index_in), is_single_end(is_single_end_in), is_long_reads(is_long_reads_in), library_type(library_type_in), is_single_path(is_single_path_in), score_not_qual(score_not_qual_in), use_allelic_mapq(use_allelic_mapq_in), max_partial_offset(max_partial_offset_in), max_score_diff(max_score_diff_in), min_best_score_filter(min_best_score_filter_in), pre_frag_length_dist(pre_frag_length_dist_in) {}
+
+void AlignmentPathsCache::serialize(ostream & out, const AlignmentPathsIndex & align_paths_index, const FragmentLengthDist & frag_length_dist, const uint32_t unaligned_read_count) const {
+
+    writeValue<uint64_t>(out, align_paths_cache_magic);
+    writeValue<uint32_t>(out, align_paths_cache_version);
+
+    // Search states are only valid for the GBWT (and r-index) they were found in.
+    writeValue<uint32_t>(out, paths_index.numberOfPaths());
+    writeValue<uint32_t>(out, paths_index.numberOfNodes());
+    writeValue<uint8_t>(out, paths_index.bidirectional());
+    writeValue<uint8_t>(out, paths_index.hasRIndex());
+
+    writeValue<uint8_t>(out, is_single_end);
+    writeValue<uint8_t>(out, is_long_reads);
+
+    // Options used when finding the alignment paths.
+    writeValue<uint32_t>(out, library_type.size());
+    out.write(library_type.data(), library_type.size());
+
+    writeValue<uint8_t>(out, is_single_path);
+    writeValue<uint8_t>(out, score_not_qual);
+    writeValue<uint8_t>(out, use_allelic_mapq);
+    writeValue<uint32_t>(out, max_partial_offset);
+    writeValue<uint32_t>(out, max_score_diff);
+    writeValue<double>(out, min_best_score_filter);
+
+    pre_frag_length_dist.serialize(out);
+
+    frag_length_dist.serialize(out);
+    writeValue<uint32_t>(out, unaligned_read_count);
+
+    writeValue<uint64_t>(out, align_paths_index.size());
+
+    for (auto & align_paths: align_paths_index) {
+
+        assert(align_paths.first.size() > 1);
+        assert(align_paths.second > 0);
+
+        writeValue<uint32_t>(out, align_paths.second);
+        writeValue<uint32_t>(out, align_paths.first.size());
+
+        for (auto & align_path: align_paths.first) {
+
+            writeAlignmentPath(out, align_path);
+        }
+    }
+
+    assert(out.good());
+}
+
+bool AlignmentPathsCache::load(istream & in, AlignmentPathsIndex * align_paths_index, FragmentLengthDist * frag_length_dist, uint32_t * unaligned_read_count) {
+
+    assert(align_paths_index->empty());
+
+    if (readValue<uint64_t>(in) != align_paths_cache_magic || readValue<uint32_t>(in) != align_paths_cache_version) {
+
+        return false;
+    }
+
+    if (readValue<uint32_t>(in) != paths_index.numberOfPaths() || readValue<uint32_t>(in) != paths_index.numberOfNodes()) {
+
+        return false;
+    }
+
+    if (readValue<uint8_t>(in) != paths_index.bidirectional() || readValue<uint8_t>(in) != paths_index.hasRIndex()) {
+
+        return false;
+    }
+
+    if (readValue<uint8_t>(in) != is_single_end || readValue<uint8_t>(in) != is_long_reads) {
+
+        return false;
+    }
+
+    const uint32_t library_type_length = readValue<uint32_t>(in);
+
+    if (!in.good() || library_type_length != library_type.size()) {
+
+        return false;
+    }
+
+    string cache_library_type(library_type_length, ' ');
+    in.read(&(cache_library_type.front()), library_type_length);
+
+    if (cache_library_type != library_type) {
+
+        return false;
+    }
+
+    if (readValue<uint8_t>(in) != is_single_path || readValue<uint8_t>(in) != score_not_qual || readValue<uint8_t>(in) != use_allelic_mapq) {
+
+        return false;
+    }
+
+    if (readValue<uint32_t>(in) != max_partial_offset || readValue<uint32_t>(in) != max_score_diff || readValue<double>(in) != min_best_score_filter) {
+
+        return false;
+    }
+
+    FragmentLengthDist cache_pre_frag_length_dist;
+    cache_pre_frag_length_dist.load(in);
+
+    if (!in.good() || !cache_pre_frag_length_dist.isValid()) {
+
+        return false;
+    }
+
+    if (pre_frag_length_dist.isValid()) {
+
+        if (!Utils::doubleCompare(cache_pre_frag_length_dist.loc(), pre_frag_length_dist.loc()) || !Utils::doubleCompare(cache_pre_frag_length_dist.scale(), pre_frag_length_dist.scale()) || !Utils::doubleCompare(cache_pre_frag_length_dist.shape(), pre_frag_length_dist.shape()) || cache_pre_frag_length_dist.maxLength() != pre_frag_length_dist.maxLength()) {
+
+            return false;
+        }
+
+    } else {
+
+        pre_frag_length_dist = cache_pre_frag_length_dist;
+    }
+
+    frag_length_dist->load(in);
+
+    if (!in.good() || !frag_length_dist->isValid()) {
+
+        return false;
+    }
+
+    *unaligned_read_count = readValue<uint32_t>(in);
+
+    const uint64_t num_align_paths = readValue<uint64_t>(in);
+    align_paths_index->reserve(num_align_paths);
+
+    vector<AlignmentPath> align_paths;
+
+    for (uint64_t i = 0; i < num_align_paths; ++i) {
+
+        const uint32_t read_count = readValue<uint32_t>(in);
+        const uint32_t num_paths = readValue<uint32_t>(in);
+
+        if (!in.good() || num_paths < 2) {
+
+            return false;
+        }
+
+        align_paths.clear();
+        align_paths.reserve(num_paths);
+
+        for (uint32_t j = 0; j < num_paths; ++j) {
+
+            align_paths.emplace_back(readAlignmentPath(in));
+        }
+
+        if (!in.good() || !align_paths_index->add(align_paths, read_count)) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void AlignmentPathsCache::writeAlignmentPath(ostream & out, const AlignmentPath & align_path) const {
+
+    writeValue<uint64_t>(out, align_path.gbwt_search.first.node);
+    writeValue<uint64_t>(out, align_path.gbwt_search.first.range.first);
+    writeValue<uint64_t>(out, align_path.gbwt_search.first.range.second);
+    writeValue<uint64_t>(out, align_path.gbwt_search.second);
+
+    writeValue<uint8_t>(out, align_path.is_simple);
+    writeValue<uint8_t>(out, align_path.min_mapq);
+    writeValue<int32_t>(out, align_path.score_sum);
+    writeValue<uint16_t>(out, align_path.align_length);
+    writeValue<uint16_t>(out, align_path.frag_length);
+}
+
+AlignmentPath AlignmentPathsCache::readAlignmentPath(istream & in) const {
+
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search;
+
+    gbwt_search.first.node = readValue<uint64_t>(in);
+    gbwt_search.first.range.first = readValue<uint64_t>(in);
+    gbwt_search.first.range.second = readValue<uint64_t>(in);
+    gbwt_search.second = readValue<uint64_t>(in);
+
+    const bool is_simple = readValue<uint8_t>(in);
+    const uint8_t min_mapq = readValue<uint8_t>(in);
+    const int32_t score_sum = readValue<int32_t>(in);
+    const uint16_t align_length = readValue<uint16_t>(in);
+    const uint16_t frag_length = readValue<uint16_t>(in);
+
+    return AlignmentPath(gbwt_search, is_simple, min_mapq, score_sum, align_length, frag_length);
+}
@@ -0,0 +1,56 @@
+
+#ifndef RPVG_SRC_ALIGNMENTPATHSCACHE_HPP
+#define RPVG_SRC_ALIGNMENTPATHSCACHE_HPP
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "sparsepp/spp.h"
+
+#include "paths_index.hpp"
+#include "alignment_path.hpp"
+#include "alignment_paths_index.hpp"
+#include "fragment_length_dist.hpp"
+
+using namespace std;
+
+
+class AlignmentPathsCache {
+
+    public:
+
+        // The cache is only loaded if it was written using the same paths, 
+        // read types and options for finding alignment paths. The fragment 
+        // length distribution used for finding the alignment paths is only 
+        // compared if it is valid (e.g. given as input).
+        AlignmentPathsCache(const PathsIndex & paths_index_in, const bool is_single_end_in, const bool is_long_reads_in, const string & library_type_in, const bool is_single_path_in, const bool score_not_qual_in, const bool use_allelic_mapq_in, const uint32_t max_partial_offset_in, const uint32_t max_score_diff_in, const double min_best_score_filter_in, const FragmentLengthDist & pre_frag_length_dist_in);
+
+        void serialize(ostream & out, const AlignmentPathsIndex & align_paths_index, const FragmentLengthDist & frag_length_dist, const uint32_t unaligned_read_count) const;
+        // Loading sets the fragment length distribution used for finding 
+        // the alignment paths to the cached one, if it was not valid.
+        bool load(istream & in, AlignmentPathsIndex * align_paths_index, FragmentLengthDist * frag_length_dist, uint32_t * unaligned_read_count);
+
+    private:
+
+        const PathsIndex & paths_index;
+
+        const bool is_single_end;
+        const bool is_long_reads;
+
+        const string library_type;
+        const bool is_single_path;
+        const bool score_not_qual;
+        const bool use_allelic_mapq;
+        const uint32_t max_partial_offset;
+        const uint32_t max_score_diff;
+        const double min_best_score_filter;
+
+        FragmentLengthDist pre_frag_length_dist;
+
+        void writeAlignmentPath(ostream & out, const AlignmentPath & align_path) const;
+        AlignmentPath readAlignmentPath(istream & in) const;
+};
+
+
+#endif
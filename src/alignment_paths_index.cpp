@@ -0,0 +1,127 @@
+
+#include "alignment_paths_index.hpp"
+
+#include <assert.h>
+
+
+// Number of alignment paths in each arena block.
+static const uint32_t arena_block_size = 65536;
+
+AlignmentPathsIndex::AlignmentPathsIndex() {}
+
+size_t AlignmentPathsIndex::size() const {
+
+    return index.size();
+}
+
+bool AlignmentPathsIndex::empty() const {
+
+    return index.empty();
+}
+
+void AlignmentPathsIndex::reserve(const size_t num_keys) {
+
+    index.reserve(num_keys);
+}
+
+AlignmentPathsIndex::const_iterator AlignmentPathsIndex::begin() const {
+
+    return index.begin();
+}
+
+AlignmentPathsIndex::const_iterator AlignmentPathsIndex::end() const {
+
+    return index.end();
+}
+
+AlignmentPathsIndex::const_iterator AlignmentPathsIndex::find(const AlignmentPathSpan & align_paths) const {
+
+    return index.find(AlignmentPathsKey(align_paths));
+}
+
+vector<AlignmentPathsIndex::const_iterator> AlignmentPathsIndex::iterators() const {
+
+    vector<const_iterator> index_its;
+    index_its.reserve(index.size());
+
+    for (auto index_it = index.begin(); index_it != index.end(); ++index_it) {
+
+        index_its.emplace_back(index_it);
+    }
+
+    return index_its;
+}
+
+bool AlignmentPathsIndex::add(const AlignmentPathSpan & align_paths, const uint32_t read_count) {
+
+    assert(!align_paths.empty());
+
+    // Lookup using a key pointing to the input, which is replaced 
+    // by a key pointing to the arena if the paths are new.
+    const AlignmentPathsKey align_paths_key(align_paths);
+
+    auto index_it = index.find(align_paths_key);
+
+    if (index_it != index.end()) {
+
+        index_it->second += read_count;
+        return false;
+    }
+
+    index.emplace(AlignmentPathsKey(addToArena(align_paths), align_paths_key.hash), read_count);
+    return true;
+}
+
+void AlignmentPathsIndex::merge(AlignmentPathsIndex * other_index) {
+
+    // Moving the arena blocks does not change the location 
+    // of their content and the keys therefore remain valid.
+    arena_blocks.reserve(arena_blocks.size() + other_index->arena_blocks.size());
+
+    for (auto & arena_block: other_index->arena_blocks) {
+
+        arena_blocks.emplace_back(move(arena_block));
+    }
+
+    index.reserve(index.size() + other_index->index.size());
+
+    for (auto & align_paths: other_index->index) {
+
+        assert(index.find(align_paths.first) == index.end());
+        index.emplace(align_paths.first, align_paths.second);
+    }
+
+    other_index->index = index_t();
+    other_index->arena_blocks.clear();
+}
+
+uint64_t AlignmentPathsIndex::arenaBytes() const {
+
+    uint64_t arena_bytes = 0;
+
+    for (auto & arena_block: arena_blocks) {
+
+        arena_bytes += arena_block.capacity() * sizeof(AlignmentPath);
+    }
+
+    return arena_bytes;
+}
+
+AlignmentPathSpan AlignmentPathsIndex::addToArena(const AlignmentPathSpan & align_paths) {
+
+    // Blocks are never reallocated, which keeps 
+    // pointers into the arena stable.
+    if (arena_blocks.empty() || arena_blocks.back().capacity() - arena_blocks.back().size() < align_paths.size()) {
+
+        arena_blocks.emplace_back();
+        arena_blocks.back().reserve(max(arena_block_size, align_paths.size()));
+    }
+
+    auto & arena_block = arena_blocks.back();
+    const size_t arena_offset = arena_block.size();
+
+    arena_block.insert(arena_block.end(), align_paths.begin(), align_paths.end());
+    assert(arena_block.size() <= arena_block.capacity());
+
+    return AlignmentPathSpan(arena_block.data() + arena_offset, align_paths.size());
+}
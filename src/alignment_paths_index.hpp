@@ -0,0 +1,96 @@
+
+#ifndef RPVG_SRC_ALIGNMENTPATHSINDEX_HPP
+#define RPVG_SRC_ALIGNMENTPATHSINDEX_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include "sparsepp/spp.h"
+
+#include "alignment_path.hpp"
+
+using namespace std;
+
+
+// Key into the alignment paths index. Points to a sequence of alignment 
+// paths stored in the arena of the index and caches the hash of it.
+class AlignmentPathsKey : public AlignmentPathSpan {
+
+    public:
+
+        AlignmentPathsKey() : hash(0) {}
+        AlignmentPathsKey(const AlignmentPathSpan & align_paths_in) : AlignmentPathSpan(align_paths_in), hash(std::hash<AlignmentPathSpan>()(align_paths_in)) {}
+        AlignmentPathsKey(const AlignmentPathSpan & align_paths_in, const size_t hash_in) : AlignmentPathSpan(align_paths_in), hash(hash_in) {}
+
+        size_t hash;
+};
+
+struct AlignmentPathsKeyHash {
+
+    size_t operator()(const AlignmentPathsKey & key) const {
+
+        return key.hash;
+    }
+};
+
+struct AlignmentPathsKeyEqual {
+
+    bool operator()(const AlignmentPathsKey & lhs, const AlignmentPathsKey & rhs) const {
+
+        return (lhs.hash == rhs.hash && static_cast<const AlignmentPathSpan &>(lhs) == static_cast<const AlignmentPathSpan &>(rhs));
+    }
+};
+
+// Index of unique sequences of alignment paths (read equivalence classes) 
+// and their read counts. The sequences are stored contiguously in fixed 
+// size arena blocks to avoid a heap allocation per key.
+class AlignmentPathsIndex {
+
+    public:
+
+        typedef spp::sparse_hash_map<AlignmentPathsKey, uint32_t, AlignmentPathsKeyHash, AlignmentPathsKeyEqual> index_t;
+        
+        typedef index_t::const_iterator iterator;
+        typedef index_t::const_iterator const_iterator;
+
+        AlignmentPathsIndex();
+
+        AlignmentPathsIndex(const AlignmentPathsIndex &) = delete;
+        AlignmentPathsIndex & operator=(const AlignmentPathsIndex &) = delete;
+
+        AlignmentPathsIndex(AlignmentPathsIndex &&) = default;
+        AlignmentPathsIndex & operator=(AlignmentPathsIndex &&) = default;
+
+        size_t size() const;
+        bool empty() const;
+
+        void reserve(const size_t num_keys);
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator find(const AlignmentPathSpan & align_paths) const;
+
+        // Returns iterators to all alignment paths in iteration order, 
+        // which can be partitioned into disjoint ranges between threads.
+        vector<const_iterator> iterators() const;
+
+        // Adds read count to the alignment paths and returns 
+        // true if they were not already in the index.
+        bool add(const AlignmentPathSpan & align_paths, const uint32_t read_count);
+
+        // Moves all alignment paths in other index, which are required 
+        // to not overlap with this index, into this index.
+        void merge(AlignmentPathsIndex * other_index);
+
+        uint64_t arenaBytes() const;
+
+    private:
+
+        index_t index;
+        vector<vector<AlignmentPath> > arena_blocks;
+
+        AlignmentPathSpan addToArena(const AlignmentPathSpan & align_paths);
+};
+
+
+#endif
@@ -0,0 +1,95 @@
+
+#include "concurrent_union_find.hpp"
+
+#include <assert.h>
+#include <algorithm>
+
+
+static const uint64_t parent_mask = 0xFFFFFFFFULL;
+
+ConcurrentUnionFind::ConcurrentUnionFind(const uint32_t num_ids) : ranks_parents(num_ids) {
+
+    for (uint32_t i = 0; i < num_ids; ++i) {
+
+        ranks_parents.at(i).store(i);
+    }
+}
+
+uint32_t ConcurrentUnionFind::size() const {
+
+    return ranks_parents.size();
+}
+
+uint32_t ConcurrentUnionFind::find(uint32_t id) const {
+
+    assert(id < ranks_parents.size());
+
+    while (id != parent(id)) {
+
+        uint64_t rank_parent = ranks_parents.at(id).load();
+
+        const uint32_t grandparent = parent(rank_parent & parent_mask);
+        const uint64_t new_rank_parent = (rank_parent & ~parent_mask) | grandparent;
+
+        // Failing to update the parent is fine since another
+        // thread has then changed it to an ancestor or a new root.
+        if (rank_parent != new_rank_parent) {
+
+            ranks_parents.at(id).compare_exchange_weak(rank_parent, new_rank_parent);
+        }
+
+        id = grandparent;
+    }
+
+    return id;
+}
+
+void ConcurrentUnionFind::unite(uint32_t id_1, uint32_t id_2) {
+
+    while (true) {
+
+        id_1 = find(id_1);
+        id_2 = find(id_2);
+
+        if (id_1 == id_2) {
+
+            return;
+        }
+
+        uint32_t rank_1 = rank(id_1);
+        uint32_t rank_2 = rank(id_2);
+
+        // The root with the lowest rank (and id for equal ranks)
+        // is attached to the other root.
+        if (rank_1 > rank_2 || (rank_1 == rank_2 && id_1 > id_2)) {
+
+            swap(rank_1, rank_2);
+            swap(id_1, id_2);
+        }
+
+        uint64_t rank_parent_1 = (static_cast<uint64_t>(rank_1) << 32) | id_1;
+
+        if (!ranks_parents.at(id_1).compare_exchange_strong(rank_parent_1, (static_cast<uint64_t>(rank_1) << 32) | id_2)) {
+
+            continue;
+        }
+
+        if (rank_1 == rank_2) {
+
+            uint64_t rank_parent_2 = (static_cast<uint64_t>(rank_2) << 32) | id_2;
+            ranks_parents.at(id_2).compare_exchange_weak(rank_parent_2, (static_cast<uint64_t>(rank_2 + 1) << 32) | id_2);
+        }
+
+        return;
+    }
+}
+
+uint32_t ConcurrentUnionFind::parent(const uint32_t id) const {
+
+    return ranks_parents.at(id).load() & parent_mask;
+}
+
+uint32_t ConcurrentUnionFind::rank(const uint32_t id) const {
+
+    return ranks_parents.at(id).load() >> 32;
+}
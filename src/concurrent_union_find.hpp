@@ -0,0 +1,35 @@
+
+#ifndef RPVG_SRC_CONCURRENTUNIONFIND_HPP
+#define RPVG_SRC_CONCURRENTUNIONFIND_HPP
+
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+
+// Lock-free union-find (disjoint sets) over the ids 0 to size - 1. The rank
+// and parent of each id are packed in a single atomic value that is updated
+// using compare-and-swap. Sets are united by rank and finds use path halving.
+class ConcurrentUnionFind {
+
+    public:
+
+        ConcurrentUnionFind(const uint32_t num_ids);
+
+        uint32_t size() const;
+
+        uint32_t find(uint32_t id) const;
+        void unite(uint32_t id_1, uint32_t id_2);
+
+    private:
+
+        // Path halving only changes the parents of ids and not the sets.
+        mutable vector<atomic<uint64_t> > ranks_parents;
+
+        uint32_t parent(const uint32_t id) const;
+        uint32_t rank(const uint32_t id) const;
+};
+
+
+#endif
@@ -26,7 +26,7 @@ FragmentLengthDist::FragmentLengthDist(const double loc_in, const double scale_i
     setLogProbBuffer(max_length_);
 }
 
-FragmentLengthDist::FragmentLengthDist(istream * alignments_istream, const bool is_multipath, const uint32_t sd_max_multi) {
+FragmentLengthDist::FragmentLengthDist(istream * alignments_istream, const bool is_multipath, const uint32_t sd_max_multi) : loc_(0), scale_(0), shape_(0), max_length_(0) {
 
     assert(alignments_istream->good());
 
@@ -51,10 +51,12 @@ FragmentLengthDist::FragmentLengthDist(istream * alignments_istream, const bool
         }
     }
 
-    assert(isValid());
+    // The parameters might not be found before the end of the alignments.
+    if (isValid()) {
 
-    setMaxLength(sd_max_multi);
-    setLogProbBuffer(max_length_);
+        setMaxLength(sd_max_multi);
+        setLogProbBuffer(max_length_);
+    }
 }
 
 FragmentLengthDist::FragmentLengthDist(const vector<uint32_t> & frag_length_counts, const bool skew_normal) {
@@ -356,6 +358,29 @@ bool FragmentLengthDist::parseMultipathAlignment(const vg::MultipathAlignment &
     return false;
 }
 
+void FragmentLengthDist::serialize(ostream & out) const {
+
+    assert(isValid());
+
+    out.write(reinterpret_cast<const char *>(&loc_), sizeof(loc_));
+    out.write(reinterpret_cast<const char *>(&scale_), sizeof(scale_));
+    out.write(reinterpret_cast<const char *>(&shape_), sizeof(shape_));
+    out.write(reinterpret_cast<const char *>(&max_length_), sizeof(max_length_));
+}
+
+void FragmentLengthDist::load(istream & in) {
+
+    in.read(reinterpret_cast<char *>(&loc_), sizeof(loc_));
+    in.read(reinterpret_cast<char *>(&scale_), sizeof(scale_));
+    in.read(reinterpret_cast<char *>(&shape_), sizeof(shape_));
+    in.read(reinterpret_cast<char *>(&max_length_), sizeof(max_length_));
+
+    if (in.good() && isValid()) {
+
+        setLogProbBuffer(max_length_);
+    }
+}
+
 double FragmentLengthDist::loc() const {
 
     return loc_;
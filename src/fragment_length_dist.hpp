@@ -31,6 +31,9 @@ class FragmentLengthDist {
         bool parseAlignment(const vg::Alignment & alignment);
         bool parseMultipathAlignment(const vg::MultipathAlignment & alignment);
 
+        void serialize(ostream & out) const;
+        void load(istream & in);
+
     private:
         
         double loc_;
@@ -0,0 +1,170 @@
+
+#include "input_stream_buffers.hpp"
+
+#include <assert.h>
+#include <algorithm>
+
+#include "gbwt/utils.h"
+
+
+static const uint32_t input_buffer_size = 65536;
+
+RewindableInputBuffer::RewindableInputBuffer(streambuf * source_buffer_in, const uint64_t max_recorded_bytes_in) : source_buffer(source_buffer_in), max_recorded_bytes(max_recorded_bytes_in), is_recording(true), is_replaying(false), is_recording_limit_reached(false) {
+
+    assert(source_buffer);
+    read_bytes = vector<char>(input_buffer_size);
+
+    setg(nullptr, nullptr, nullptr);
+}
+
+void RewindableInputBuffer::rewind() {
+
+    assert(is_recording);
+    is_recording = false;
+
+    if (!recorded_bytes.empty()) {
+
+        is_replaying = true;
+        setg(&recorded_bytes.front(), &recorded_bytes.front(), &recorded_bytes.front() + recorded_bytes.size());
+    
+    } else {
+
+        setg(nullptr, nullptr, nullptr);
+    }
+}
+
+bool RewindableInputBuffer::isRecording() const {
+
+    return is_recording;
+}
+
+bool RewindableInputBuffer::recordingLimitReached() const {
+
+    return is_recording_limit_reached;
+}
+
+RewindableInputBuffer::int_type RewindableInputBuffer::underflow() {
+
+    if (gptr() < egptr()) {
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    if (is_replaying) {
+
+        is_replaying = false;
+        
+        recorded_bytes.clear();
+        recorded_bytes.shrink_to_fit();
+    }
+
+    uint64_t max_read_bytes = read_bytes.size();
+
+    if (is_recording) {
+
+        assert(recorded_bytes.size() <= max_recorded_bytes);
+        max_read_bytes = min(max_read_bytes, max_recorded_bytes - recorded_bytes.size());
+
+        if (max_read_bytes == 0) {
+
+            is_recording_limit_reached = true;
+
+            setg(nullptr, nullptr, nullptr);
+            return traits_type::eof();
+        }
+    }
+
+    const streamsize num_read_bytes = source_buffer->sgetn(&read_bytes.front(), max_read_bytes);
+
+    if (num_read_bytes <= 0) {
+
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+
+    if (is_recording) {
+
+        recorded_bytes.insert(recorded_bytes.end(), read_bytes.begin(), read_bytes.begin() + num_read_bytes);
+    }
+
+    setg(&read_bytes.front(), &read_bytes.front(), &read_bytes.front() + num_read_bytes);
+    return traits_type::to_int_type(*gptr());
+}
+
+BgzfInputBuffer::BgzfInputBuffer(const string & filename, const uint32_t num_threads) : num_fills(0), decompressed_bytes(0), decompression_time(0) {
+
+    assert(num_threads > 0);
+
+    bgzf_file = bgzf_open(filename.c_str(), "r");
+
+    if (bgzf_file && num_threads > 1) {
+
+        const int mt_status = bgzf_mt(bgzf_file, num_threads, 256);
+        assert(mt_status == 0);
+    }
+
+    read_bytes = vector<char>(input_buffer_size);
+    setg(nullptr, nullptr, nullptr);
+}
+
+BgzfInputBuffer::~BgzfInputBuffer() {
+
+    if (bgzf_file) {
+
+        assert(bgzf_close(bgzf_file) == 0);
+    }
+}
+
+bool BgzfInputBuffer::isOpen() const {
+
+    return bgzf_file;
+}
+
+bool BgzfInputBuffer::isCompressed() const {
+
+    assert(bgzf_file);
+    return bgzf_file->is_compressed;
+}
+
+uint64_t BgzfInputBuffer::numFills() const {
+
+    return num_fills;
+}
+
+uint64_t BgzfInputBuffer::decompressedBytes() const {
+
+    return decompressed_bytes;
+}
+
+double BgzfInputBuffer::decompressionTime() const {
+
+    return decompression_time;
+}
+
+BgzfInputBuffer::int_type BgzfInputBuffer::underflow() {
+
+    if (gptr() < egptr()) {
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    assert(bgzf_file);
+
+    const double time_read_start = gbwt::readTimer();
+    const ssize_t num_read_bytes = bgzf_read(bgzf_file, &read_bytes.front(), read_bytes.size());
+    decompression_time += gbwt::readTimer() - time_read_start;
+
+    assert(num_read_bytes >= 0);
+
+    if (num_read_bytes == 0) {
+
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+
+    num_fills++;
+    decompressed_bytes += num_read_bytes;
+
+    setg(&read_bytes.front(), &read_bytes.front(), &read_bytes.front() + num_read_bytes);
+    return traits_type::to_int_type(*gptr());
+}
@@ -0,0 +1,83 @@
+
+#ifndef RPVG_SRC_INPUTSTREAMBUFFERS_HPP
+#define RPVG_SRC_INPUTSTREAMBUFFERS_HPP
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "htslib/bgzf.h"
+#include "htslib/hts.h"
+
+using namespace std;
+
+
+// Stream buffer that records everything read from a source buffer until
+// rewind() is called, after which the recorded bytes are replayed before
+// reading continues from the source. Allows the start of non-seekable 
+// input (e.g. stdin or named pipes) to be parsed twice. At most the given 
+// number of bytes are recorded, after which the buffer returns end of file 
+// until it is rewound.
+class RewindableInputBuffer : public streambuf {
+
+    public:
+
+        RewindableInputBuffer(streambuf * source_buffer_in, const uint64_t max_recorded_bytes_in);
+
+        void rewind();
+        bool isRecording() const;
+        bool recordingLimitReached() const;
+
+    protected:
+
+        int_type underflow();
+
+    private:
+
+        streambuf * source_buffer;
+        
+        const uint64_t max_recorded_bytes;
+
+        bool is_recording;
+        bool is_replaying;
+        bool is_recording_limit_reached;
+
+        vector<char> recorded_bytes;
+        vector<char> read_bytes;
+};
+
+// Stream buffer that decompresses a BGZF file (use - for stdin) using a 
+// pool of htslib threads, so that block decompression runs in parallel 
+// ahead of the message parsing. Uncompressed input is passed through.
+class BgzfInputBuffer : public streambuf {
+
+    public:
+
+        BgzfInputBuffer(const string & filename, const uint32_t num_threads);
+        ~BgzfInputBuffer();
+
+        bool isOpen() const;
+        bool isCompressed() const;
+
+        uint64_t numFills() const;
+        uint64_t decompressedBytes() const;
+        double decompressionTime() const;
+
+    protected:
+
+        int_type underflow();
+
+    private:
+
+        BGZF * bgzf_file;
+
+        vector<char> read_bytes;
+
+        uint64_t num_fills;
+        uint64_t decompressed_bytes;
+        double decompression_time;
+};
+
+
+#endif
@@ -0,0 +1,255 @@
+
+#include "job_server.hpp"
+
+#include <assert.h>
+#include <sstream>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+
+static const int job_server_backlog = 64;
+
+// Time in milliseconds between checks for a shutdown 
+// while waiting for a connection.
+static const int job_server_poll_timeout = 100;
+
+// Time in seconds that a client has to send the job line. Clients that do 
+// not send a line would otherwise hold a job slot indefinitely.
+static const int job_server_read_timeout = 10;
+
+static const string job_server_shutdown_command = "shutdown";
+
+JobServer::JobServer(const string & socket_filename_in, const uint32_t max_num_jobs_in) : socket_filename(socket_filename_in), max_num_jobs(max_num_jobs_in), is_shutdown(false) {
+
+    assert(max_num_jobs > 0);
+
+    socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (socket_fd < 0) {
+
+        return;
+    }
+
+    sockaddr_un socket_address;
+    memset(&socket_address, 0, sizeof(socket_address));
+
+    socket_address.sun_family = AF_UNIX;
+
+    if (socket_filename.size() >= sizeof(socket_address.sun_path)) {
+
+        close(socket_fd);
+        socket_fd = -1;
+
+        return;
+    }
+
+    strncpy(socket_address.sun_path, socket_filename.c_str(), sizeof(socket_address.sun_path) - 1);
+
+    // Remove socket left behind by a previous server.
+    unlink(socket_filename.c_str());
+
+    // Only the user running the server can submit jobs.
+    if (bind(socket_fd, reinterpret_cast<sockaddr *>(&socket_address), sizeof(socket_address)) != 0 || chmod(socket_filename.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(socket_fd, job_server_backlog) != 0) {
+
+        close(socket_fd);
+        socket_fd = -1;
+    }
+}
+
+JobServer::~JobServer() {
+
+    if (socket_fd >= 0) {
+
+        close(socket_fd);
+        unlink(socket_filename.c_str());
+    }
+}
+
+bool JobServer::isOpen() const {
+
+    return (socket_fd >= 0);
+}
+
+void JobServer::run(function<int(const uint64_t, const vector<string> &)> job_function) {
+
+    assert(isOpen());
+    is_shutdown = false;
+
+    uint64_t num_jobs = 0;
+    vector<pair<uint64_t, thread> > job_threads;
+
+    while (!is_shutdown) {
+
+        {
+            unique_lock<mutex> finished_jobs_lock(finished_jobs_mutex);
+            finished_jobs_cv.wait(finished_jobs_lock, [&]() { return (job_threads.size() - finished_job_ids.size() < max_num_jobs); });
+
+            // Join finished job threads.
+            for (auto & finished_job_id: finished_job_ids) {
+
+                auto job_threads_it = find_if(job_threads.begin(), job_threads.end(), [&](const pair<uint64_t, thread> & job_thread) { return job_thread.first == finished_job_id; });
+                assert(job_threads_it != job_threads.end());
+
+                job_threads_it->second.join();
+                job_threads.erase(job_threads_it);
+            }
+
+            finished_job_ids.clear();
+        }
+
+        if (is_shutdown) {
+
+            break;
+        }
+
+        // Shutdown lines are read by the job threads, 
+        // so the accept can not block indefinitely.
+        pollfd socket_poll;
+
+        socket_poll.fd = socket_fd;
+        socket_poll.events = POLLIN;
+        socket_poll.revents = 0;
+
+        const int poll_status = poll(&socket_poll, 1, job_server_poll_timeout);
+
+        if (poll_status <= 0) {
+
+            if (poll_status == 0 || errno == EINTR) {
+
+                continue;
+            }
+
+            break;
+        }
+
+        const int connection_fd = accept(socket_fd, nullptr, nullptr);
+
+        if (connection_fd < 0) {
+
+            if (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED) {
+
+                continue;
+            }
+
+            break;
+        }
+
+        ++num_jobs;
+        const uint64_t job_id = num_jobs;
+
+        job_threads.emplace_back(job_id, thread([this, connection_fd, job_id, &job_function]() {
+
+            string job_line;
+
+            // Connections that do not send a job line in time are closed.
+            if (readLine(connection_fd, &job_line)) {
+
+                if (job_line == job_server_shutdown_command) {
+
+                    is_shutdown = true;
+                    writeLine(connection_fd, "0");
+                
+                } else {
+
+                    vector<string> job_args;
+
+                    stringstream job_line_ss(job_line);
+                    string job_arg;
+
+                    while (job_line_ss >> job_arg) {
+
+                        job_args.emplace_back(job_arg);
+                    }
+
+                    writeLine(connection_fd, to_string(job_function(job_id, job_args)));
+                }
+            }
+
+            close(connection_fd);
+
+            lock_guard<mutex> finished_jobs_lock(finished_jobs_mutex);
+            
+            finished_job_ids.emplace_back(job_id);
+            finished_jobs_cv.notify_one();
+        }));
+    }
+
+    for (auto & job_thread: job_threads) {
+
+        job_thread.second.join();
+    }
+
+    finished_job_ids.clear();
+}
+
+bool JobServer::readLine(const int connection_fd, string * line) const {
+
+    timeval read_timeout;
+
+    read_timeout.tv_sec = job_server_read_timeout;
+    read_timeout.tv_usec = 0;
+
+    if (setsockopt(connection_fd, SOL_SOCKET, SO_RCVTIMEO, &read_timeout, sizeof(read_timeout)) != 0) {
+
+        return false;
+    }
+
+    char cur_char = 0;
+
+    while (true) {
+
+        const ssize_t num_read = read(connection_fd, &cur_char, 1);
+
+        // Fails on timeout or other read errors. The line 
+        // is complete at the end of the connection.
+        if (num_read < 0) {
+
+            if (errno == EINTR) {
+
+                continue;
+            }
+
+            return false;
+        }
+
+        if (num_read == 0 || cur_char == '\n') {
+
+            break;
+        }
+
+        *line += cur_char;
+    }
+
+    if (!line->empty() && line->back() == '\r') {
+
+        line->pop_back();
+    }
+
+    return true;
+}
+
+void JobServer::writeLine(const int connection_fd, const string & line) const {
+
+    const string line_newline = line + "\n";
+    size_t num_written = 0;
+
+    while (num_written < line_newline.size()) {
+
+        // Clients that disconnect early should not terminate the server.
+        const ssize_t cur_num_written = send(connection_fd, line_newline.data() + num_written, line_newline.size() - num_written, MSG_NOSIGNAL);
+
+        if (cur_num_written <= 0) {
+
+            break;
+        }
+
+        num_written += cur_num_written;
+    }
+}
@@ -0,0 +1,57 @@
+
+#ifndef RPVG_SRC_JOBSERVER_HPP
+#define RPVG_SRC_JOBSERVER_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+
+// Server that accepts jobs over a local UNIX socket. Each job is a single 
+// line of whitespace-separated command line arguments and is read and run 
+// in a separate thread. At most the given number of jobs are run at the 
+// same time and further connections wait in the socket backlog. Jobs are 
+// numbered from 1 in order of connection. The exit status of the job is 
+// written back to the client before the connection is closed. Connections 
+// that do not send a line within a timeout are closed. A "shutdown" line 
+// stops the server once all running jobs have finished. The socket can 
+// only be used by the user running the server.
+class JobServer {
+
+    public:
+
+        JobServer(const string & socket_filename_in, const uint32_t max_num_jobs_in);
+        ~JobServer();
+
+        bool isOpen() const;
+
+        void run(function<int(const uint64_t, const vector<string> &)> job_function);
+
+    private:
+
+        const string socket_filename;
+        const uint32_t max_num_jobs;
+
+        int socket_fd;
+
+        // Ids of jobs whose thread is finished but not yet joined.
+        vector<uint64_t> finished_job_ids;
+        
+        mutex finished_jobs_mutex;
+        condition_variable finished_jobs_cv;
+
+        atomic<bool> is_shutdown;
+
+        // Returns false if no complete line was received in time.
+        bool readLine(const int connection_fd, string * line) const;
+        void writeLine(const int connection_fd, const string & line) const;
+};
+
+
+#endif
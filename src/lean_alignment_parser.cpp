@@ -0,0 +1,306 @@
+
+#include "lean_alignment_parser.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <omp.h>
+
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/wire_format_lite.h"
+#include "vg/io/message_iterator.hpp"
+
+using google::protobuf::internal::WireFormatLite;
+
+
+// Maximum number of unprocessed batches per thread.
+static const uint32_t max_num_batches_per_thread = 4;
+
+// Field number of the map entries in a google.protobuf.Struct and of the
+// key in each map entry.
+static const uint32_t struct_fields_field_number = 1;
+static const uint32_t struct_entry_key_field_number = 1;
+
+// Parameters of the 64-bit FNV-1a hash.
+static const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+static const uint64_t fnv_prime = 1099511628211ULL;
+
+LeanMessageFilter::LeanMessageFilter(const google::protobuf::Descriptor * descriptor, const vector<string> & field_names, const vector<string> & annotation_keys_in) : annotation_field_number(0), annotation_keys(annotation_keys_in.begin(), annotation_keys_in.end()) {
+
+    for (auto & field_name: field_names) {
+
+        auto field_descriptor = descriptor->FindFieldByName(field_name);
+
+        if (!field_descriptor) {
+
+            continue;
+        }
+
+        if (field_name == "annotation") {
+
+            annotation_field_number = field_descriptor->number();
+
+        } else {
+
+            field_numbers.emplace(field_descriptor->number());
+        }
+    }
+}
+
+void LeanMessageFilter::filter(const string & message, string * filtered_message) const {
+
+    filtered_message->clear();
+
+    google::protobuf::io::CodedInputStream message_istream(reinterpret_cast<const uint8_t *>(message.data()), message.size());
+
+    // The output stream trims the filtered message when it is destroyed.
+    google::protobuf::io::StringOutputStream filtered_message_zostream(filtered_message);
+    google::protobuf::io::CodedOutputStream filtered_message_ostream(&filtered_message_zostream);
+
+    string annotation;
+    string filtered_annotation;
+
+    uint32_t tag = message_istream.ReadTag();
+
+    while (tag != 0) {
+
+        const uint32_t field_number = WireFormatLite::GetTagFieldNumber(tag);
+
+        if (field_number == annotation_field_number && WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+
+            uint32_t annotation_length = 0;
+
+            const bool is_read = message_istream.ReadVarint32(&annotation_length) && message_istream.ReadString(&annotation, annotation_length);
+            assert(is_read);
+
+            filterAnnotation(annotation, &filtered_annotation);
+
+            filtered_message_ostream.WriteTag(tag);
+            filtered_message_ostream.WriteVarint32(filtered_annotation.size());
+            filtered_message_ostream.WriteString(filtered_annotation);
+
+        } else if (field_numbers.count(field_number)) {
+
+            const bool is_copied = WireFormatLite::SkipField(&message_istream, tag, &filtered_message_ostream);
+            assert(is_copied);
+
+        } else {
+
+            const bool is_skipped = WireFormatLite::SkipField(&message_istream, tag);
+            assert(is_skipped);
+        }
+
+        tag = message_istream.ReadTag();
+    }
+}
+
+void LeanMessageFilter::filterAnnotation(const string & annotation, string * filtered_annotation) const {
+
+    filtered_annotation->clear();
+
+    google::protobuf::io::CodedInputStream annotation_istream(reinterpret_cast<const uint8_t *>(annotation.data()), annotation.size());
+
+    google::protobuf::io::StringOutputStream filtered_annotation_zostream(filtered_annotation);
+    google::protobuf::io::CodedOutputStream filtered_annotation_ostream(&filtered_annotation_zostream);
+
+    string entry;
+    string key;
+
+    uint32_t tag = annotation_istream.ReadTag();
+
+    while (tag != 0) {
+
+        if (WireFormatLite::GetTagFieldNumber(tag) != struct_fields_field_number || WireFormatLite::GetTagWireType(tag) != WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+
+            const bool is_skipped = WireFormatLite::SkipField(&annotation_istream, tag);
+            assert(is_skipped);
+
+            tag = annotation_istream.ReadTag();
+            continue;
+        }
+
+        uint32_t entry_length = 0;
+
+        const bool is_read = annotation_istream.ReadVarint32(&entry_length) && annotation_istream.ReadString(&entry, entry_length);
+        assert(is_read);
+
+        google::protobuf::io::CodedInputStream entry_istream(reinterpret_cast<const uint8_t *>(entry.data()), entry.size());
+
+        key.clear();
+        uint32_t entry_tag = entry_istream.ReadTag();
+
+        while (entry_tag != 0) {
+
+            if (WireFormatLite::GetTagFieldNumber(entry_tag) == struct_entry_key_field_number && WireFormatLite::GetTagWireType(entry_tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+
+                uint32_t key_length = 0;
+
+                const bool is_key_read = entry_istream.ReadVarint32(&key_length) && entry_istream.ReadString(&key, key_length);
+                assert(is_key_read);
+
+                break;
+            }
+
+            const bool is_skipped = WireFormatLite::SkipField(&entry_istream, entry_tag);
+            assert(is_skipped);
+
+            entry_tag = entry_istream.ReadTag();
+        }
+
+        if (annotation_keys.count(key)) {
+
+            filtered_annotation_ostream.WriteTag(tag);
+            filtered_annotation_ostream.WriteVarint32(entry.size());
+            filtered_annotation_ostream.WriteString(entry);
+        }
+
+        tag = annotation_istream.ReadTag();
+    }
+}
+
+AlignmentDedupKeyBuilder::AlignmentDedupKeyBuilder(const google::protobuf::Descriptor * descriptor, const vector<string> & field_names, const vector<string> & annotation_keys) : message_filter(descriptor, field_names, annotation_keys) {}
+
+void AlignmentDedupKeyBuilder::clear() {
+
+    key_messages.clear();
+}
+
+void AlignmentDedupKeyBuilder::addAlignment(const google::protobuf::Message & alignment) {
+
+    message.clear();
+
+    {
+        google::protobuf::io::StringOutputStream message_zostream(&message);
+        google::protobuf::io::CodedOutputStream message_ostream(&message_zostream);
+
+        message_ostream.SetSerializationDeterministic(true);
+
+        const bool is_serialized = alignment.SerializeToCodedStream(&message_ostream);
+        assert(is_serialized);
+    }
+
+    message_filter.filter(message, &filtered_message);
+
+    const uint32_t filtered_message_length = filtered_message.size();
+
+    key_messages.append(reinterpret_cast<const char *>(&filtered_message_length), sizeof(uint32_t));
+    key_messages.append(filtered_message);
+}
+
+pair<uint64_t, uint64_t> AlignmentDedupKeyBuilder::key() const {
+
+    // The two halves use unrelated hash functions (std::hash and 64-bit 
+    // FNV-1a), which makes collisions between different reads negligible.
+    uint64_t fnv_hash = fnv_offset_basis;
+
+    for (auto & key_char: key_messages) {
+
+        fnv_hash ^= static_cast<uint8_t>(key_char);
+        fnv_hash *= fnv_prime;
+    }
+
+    return make_pair(static_cast<uint64_t>(hash<string>()(key_messages)), fnv_hash);
+}
+
+void forEachMessageBatchParallel(istream & messages_istream, const uint32_t batch_size, function<bool(const string &)> is_valid_tag, function<void(const vector<string> &)> process_batch) {
+
+    assert(batch_size > 0);
+
+    uint32_t num_unprocessed_batches = 0;
+
+    mutex batches_mutex;
+    condition_variable batches_cv;
+
+    // First error message, which is set while holding the mutex.
+    atomic<bool> has_error(false);
+    string error_message;
+
+    auto set_error = [&](const string & message) {
+
+        lock_guard<mutex> batches_lock(batches_mutex);
+
+        if (!has_error.load()) {
+
+            error_message = message;
+            has_error.store(true);
+        }
+    };
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+            const uint32_t max_num_unprocessed_batches = omp_get_num_threads() * max_num_batches_per_thread;
+
+            // Tasks are run immediately without other threads, which 
+            // keeps the reading thread from waiting on its own tasks.
+            const bool is_deferred = (omp_get_num_threads() > 1);
+
+            try {
+
+                vg::io::MessageIterator message_it(messages_istream);
+
+                while (message_it.has_current() && !has_error.load()) {
+
+                    unique_ptr<vector<string> > batch(new vector<string>());
+                    batch->reserve(batch_size);
+
+                    while (message_it.has_current() && batch->size() < batch_size) {
+
+                        auto & tagged_message = *message_it;
+
+                        if (tagged_message.second && is_valid_tag(tagged_message.first)) {
+
+                            batch->emplace_back(move(*(tagged_message.second)));
+                        }
+
+                        ++message_it;
+                    }
+
+                    {
+                        // The other threads process the started batches
+                        // while waiting at the end of the single region.
+                        unique_lock<mutex> batches_lock(batches_mutex);
+                        batches_cv.wait(batches_lock, [&]() { return num_unprocessed_batches < max_num_unprocessed_batches; });
+
+                        ++num_unprocessed_batches;
+                    }
+
+                    auto task_batch = batch.release();
+
+                    #pragma omp task firstprivate(task_batch) shared(num_unprocessed_batches, batches_mutex, batches_cv, process_batch, set_error) if(is_deferred)
+                    {
+                        try {
+
+                            process_batch(*task_batch);
+
+                        } catch (const exception & e) {
+
+                            set_error(e.what());
+                        }
+
+                        delete task_batch;
+
+                        {
+                            lock_guard<mutex> batches_lock(batches_mutex);
+                            --num_unprocessed_batches;
+                        }
+
+                        batches_cv.notify_one();
+                    }
+                }
+
+            } catch (const exception & e) {
+
+                set_error(e.what());
+            }
+        }
+    }
+
+    if (has_error.load()) {
+
+        throw runtime_error(error_message);
+    }
+}
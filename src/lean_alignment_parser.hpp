@@ -0,0 +1,151 @@
+
+#ifndef RPVG_SRC_LEANALIGNMENTPARSER_HPP
+#define RPVG_SRC_LEANALIGNMENTPARSER_HPP
+
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+
+#include "sparsepp/spp.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "vg/io/registry.hpp"
+
+using namespace std;
+
+
+// Number of serialized messages in each batch (even to keep pairs together).
+static const uint32_t lean_alignment_batch_size = 512;
+
+// Filters serialized protobuf messages in the wire format such that only
+// the given top-level fields and annotation keys are kept. Parsing the
+// filtered message avoids allocating and decoding unused fields.
+class LeanMessageFilter {
+
+    public:
+
+        LeanMessageFilter(const google::protobuf::Descriptor * descriptor, const vector<string> & field_names, const vector<string> & annotation_keys_in);
+
+        void filter(const string & message, string * filtered_message) const;
+
+    private:
+
+        spp::sparse_hash_set<uint32_t> field_numbers;
+
+        uint32_t annotation_field_number;
+        spp::sparse_hash_set<string> annotation_keys;
+
+        void filterAnnotation(const string & annotation, string * filtered_annotation) const;
+};
+
+// Hash of a fixed-width (128 bit) read deduplication key.
+struct AlignmentDedupKeyHash {
+
+    size_t operator()(const pair<uint64_t, uint64_t> & dedup_key) const {
+
+        return dedup_key.first;
+    }
+};
+
+// Builds fixed-width read deduplication keys by hashing the given fields 
+// and annotation keys of one or more alignments. The alignments are 
+// serialized deterministically (sorted map entries) before unused fields, 
+// such as the read name, are filtered out, so identical reads always get 
+// the same key.
+class AlignmentDedupKeyBuilder {
+
+    public:
+
+        AlignmentDedupKeyBuilder(const google::protobuf::Descriptor * descriptor, const vector<string> & field_names, const vector<string> & annotation_keys);
+
+        void clear();
+        void addAlignment(const google::protobuf::Message & alignment);
+
+        pair<uint64_t, uint64_t> key() const;
+
+    private:
+
+        const LeanMessageFilter message_filter;
+
+        string message;
+        string filtered_message;
+
+        // Length prefixed filtered messages of the added alignments.
+        string key_messages;
+};
+
+// Reads batches of serialized messages with the given tag check and
+// processes each batch in a separate OpenMP task. Reading stops at the
+// first error, which is thrown as a runtime_error once all started
+// batches have been processed.
+void forEachMessageBatchParallel(istream & messages_istream, const uint32_t batch_size, function<bool(const string &)> is_valid_tag, function<void(const vector<string> &)> process_batch);
+
+// Parses filtered alignments into a thread-local alignment and calls the
+// lambda for each alignment in parallel.
+template<class AlignmentType, class Function>
+void forEachLeanAlignmentParallel(istream & alignments_istream, const LeanMessageFilter & message_filter, Function lambda) {
+
+    forEachMessageBatchParallel(alignments_istream, lean_alignment_batch_size, [](const string & tag) { return vg::io::Registry::check_protobuf_tag<AlignmentType>(tag); }, [&](const vector<string> & batch) {
+
+        thread_local string filtered_message;
+        thread_local AlignmentType alignment;
+
+        for (auto & message: batch) {
+
+            message_filter.filter(message, &filtered_message);
+
+            if (!alignment.ParseFromString(filtered_message)) {
+
+                throw runtime_error("Could not parse alignment");
+            }
+
+            lambda(alignment);
+        }
+    });
+}
+
+// Parses filtered interleaved alignment pairs into thread-local alignments
+// and calls the lambda for each pair in parallel.
+template<class AlignmentType, class Function>
+void forEachLeanInterleavedPairParallel(istream & alignments_istream, const LeanMessageFilter & message_filter, Function lambda) {
+
+    forEachMessageBatchParallel(alignments_istream, lean_alignment_batch_size, [](const string & tag) { return vg::io::Registry::check_protobuf_tag<AlignmentType>(tag); }, [&](const vector<string> & batch) {
+
+        thread_local string filtered_message;
+
+        thread_local AlignmentType alignment_1;
+        thread_local AlignmentType alignment_2;
+
+        // Batches have an even size, so only the last batch 
+        // can end with an unpaired alignment.
+        if (batch.size() % 2 != 0) {
+
+            throw runtime_error("Interleaved alignments end with an unpaired alignment");
+        }
+
+        for (size_t i = 0; i < batch.size(); i += 2) {
+
+            message_filter.filter(batch.at(i), &filtered_message);
+
+            if (!alignment_1.ParseFromString(filtered_message)) {
+
+                throw runtime_error("Could not parse first alignment in pair");
+            }
+
+            message_filter.filter(batch.at(i + 1), &filtered_message);
+
+            if (!alignment_2.ParseFromString(filtered_message)) {
+
+                throw runtime_error("Could not parse second alignment in pair");
+            }
+
+            lambda(alignment_1, alignment_2);
+        }
+    });
+}
+
+
+#endif
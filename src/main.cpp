@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <iomanip>
 #include <thread>
+#include <functional>
 #include <sys/stat.h>
 
 #include "cxxopts.hpp"
@@ -29,62 +30,246 @@
 #include "paths_index.hpp"
 #include "alignment_path.hpp"
 #include "alignment_path_finder.hpp"
+#include "alignment_paths_index.hpp"
+#include "alignment_paths_cache.hpp"
+#include "input_stream_buffers.hpp"
 #include "producer_consumer_queue.hpp"
+#include "path_ids_index.hpp"
 #include "path_clusters.hpp"
 #include "read_path_probabilities.hpp"
 #include "path_estimator.hpp"
 #include "path_posterior_estimator.hpp"
 #include "path_abundance_estimator.hpp"
 #include "path_cluster_estimates.hpp"
+#include "path_info_parser.hpp"
 #include "threaded_output_writer.hpp"
+#include "job_server.hpp"
+#include "read_stats.hpp"
+#include "lean_alignment_parser.hpp"
 
 const uint32_t align_paths_buffer_size = 10000;
+
+// Maximum number of decompressed alignment bytes that are kept in memory 
+// while searching for the fragment length distribution parameters in 
+// alignments from stdin or a pipe.
+const uint64_t max_frag_length_search_bytes = 268435456;
 const uint32_t frag_length_min_mapq = 30;
 
-typedef spp::sparse_hash_map<vector<AlignmentPath>, uint32_t> align_paths_index_t;
+// Number of alignment path finding threads per alignment path index shard. 
+const uint32_t num_threads_per_align_paths_index_shard = 8;
+
+// Maximum number of reads in each per-thread read deduplication table.
+const uint32_t max_dedup_table_size = 16384;
+
+// Number of most expensive reads written to the read cost report.
+const uint32_t read_stats_num_top_reads = 1000;
+
+// Alignment fields and annotation keys used when finding alignment paths.
+#ifdef RPVG_READ_STATS
+const vector<string> lean_alignment_fields = {"name", "sequence", "quality", "path", "subpath", "start", "mapping_quality", "score", "annotation"};
+#else
+const vector<string> lean_alignment_fields = {"sequence", "quality", "path", "subpath", "start", "mapping_quality", "score", "annotation"};
+#endif
+const vector<string> lean_alignment_annotation_keys = {"allelic_mapq", "disconnected"};
+
+// Alignment fields hashed when deduplicating reads. The read name is 
+// excluded, since it does not affect the alignment paths.
+const vector<string> dedup_alignment_fields = {"sequence", "quality", "path", "subpath", "start", "mapping_quality", "score", "annotation"};
+
 typedef spp::sparse_hash_map<uint32_t, spp::sparse_hash_set<uint32_t> > connected_align_paths_t;
 
-typedef ProducerConsumerQueue<vector<vector<AlignmentPath> > *> align_paths_buffer_queue_t;
+// Alignment paths of recently seen reads keyed by a hash of their alignments.
+typedef spp::sparse_hash_map<pair<uint64_t, uint64_t>, vector<AlignmentPath>, AlignmentDedupKeyHash> dedup_table_t;
+
+// Buffer of alignment paths that is reused between batches. Only the first 
+// num_align_paths elements are valid, which allows the inner vectors 
+// to keep their capacity when the buffer is recycled.
+struct AlignmentPathsBuffer {
+
+    vector<vector<AlignmentPath> > align_paths;
+    uint32_t num_align_paths;
+
+    AlignmentPathsBuffer() : num_align_paths(0) {
+
+        align_paths.reserve(align_paths_buffer_size);
+    }
+
+    void add(const vector<AlignmentPath> & new_align_paths) {
+
+        if (num_align_paths < align_paths.size()) {
+
+            align_paths.at(num_align_paths) = new_align_paths;
+
+        } else {
+
+            align_paths.emplace_back(new_align_paths);
+        }
+
+        ++num_align_paths;
+    }
+
+    bool isFull() const {
+
+        return (num_align_paths == align_paths_buffer_size);
+    }
+
+    void clear() {
+
+        num_align_paths = 0;
+    }
+};
+
+typedef ProducerConsumerQueue<AlignmentPathsBuffer *> align_paths_buffer_queue_t;
+
+struct AlignmentStageStats {
+
+    uint64_t num_reads;
+    double find_time;
+
+    uint64_t num_dedup_reads;
+
+    uint64_t search_cache_lookups;
+    uint64_t search_cache_hits;
+
+#ifdef RPVG_READ_STATS
+
+    ReadStats read_stats;
+
+    AlignmentStageStats() : num_reads(0), find_time(0), num_dedup_reads(0), search_cache_lookups(0), search_cache_hits(0), read_stats(read_stats_num_top_reads) {}
+
+#else
 
+    AlignmentStageStats() : num_reads(0), find_time(0), num_dedup_reads(0), search_cache_lookups(0), search_cache_hits(0) {}
 
-bool addAlignmentPathsToBuffer(const vector<AlignmentPath> & align_paths, vector<vector<AlignmentPath> > * align_paths_buffer) {
+#endif
+};
+
+struct IndexingStageStats {
+
+    uint64_t num_buffers;
+    double index_time;
+    double wait_time;
+
+    IndexingStageStats() : num_buffers(0), index_time(0), wait_time(0) {}
+};
+
+
+AlignmentPathsBuffer * getAlignmentPathsBuffer(align_paths_buffer_queue_t * align_paths_buffer_pool) {
+
+    AlignmentPathsBuffer * align_paths_buffer = nullptr;
+
+    if (!align_paths_buffer_pool->tryPop(&align_paths_buffer)) {
+
+        align_paths_buffer = new AlignmentPathsBuffer();
+    }
+
+    assert(align_paths_buffer->num_align_paths == 0);
+    return align_paths_buffer;
+}
+
+void returnAlignmentPathsBuffer(AlignmentPathsBuffer * align_paths_buffer, align_paths_buffer_queue_t * align_paths_buffer_pool) {
+
+    align_paths_buffer->clear();
+
+    if (!align_paths_buffer_pool->tryPush(align_paths_buffer)) {
+
+        delete align_paths_buffer;
+    }
+}
+
+uint32_t alignmentPathsIndexShard(const vector<AlignmentPath> & align_paths, const uint32_t num_shards) {
+
+    // Only uses fields that are not changed when the alignment paths 
+    // are added to an index to ensure that identical alignment paths 
+    // are always assigned to the same shard.
+    size_t seed = align_paths.size();
+
+    for (auto & align_path: align_paths) {
+
+        spp::hash_combine(seed, align_path.gbwt_search.first.node);
+        spp::hash_combine(seed, align_path.gbwt_search.first.range.first);
+        spp::hash_combine(seed, align_path.gbwt_search.first.range.second);
+        spp::hash_combine(seed, align_path.gbwt_search.second);
+        spp::hash_combine(seed, align_path.is_simple);
+        spp::hash_combine(seed, align_path.min_mapq);
+    }
+
+    return seed % num_shards;
+}
+
+// Returns the alignment paths of a read (pair) with the given key from the 
+// deduplication table. If the read has not been seen recently the paths are 
+// found using find_align_paths and added to the table. Identical reads always
+// result in identical alignment paths, so the output does not change.
+template<class FindFunction> 
+const vector<AlignmentPath> & findDedupAlignmentPaths(dedup_table_t * dedup_table, const pair<uint64_t, uint64_t> & dedup_key, FindFunction find_align_paths, bool * is_duplicate) {
+
+    auto dedup_table_it = dedup_table->find(dedup_key);
+    *is_duplicate = (dedup_table_it != dedup_table->end());
+
+    if (!*is_duplicate) {
+
+        if (dedup_table->size() >= max_dedup_table_size) {
+
+            dedup_table->clear();
+        }
+
+        dedup_table_it = dedup_table->emplace(dedup_key, find_align_paths()).first;
+    }
+
+    return dedup_table_it->second;
+}
+
+bool addAlignmentPathsToBuffers(const vector<AlignmentPath> & align_paths, const vector<align_paths_buffer_queue_t *> & align_paths_buffer_queues, align_paths_buffer_queue_t * align_paths_buffer_pool, vector<AlignmentPathsBuffer *> * align_paths_buffers, vector<AlignmentPath> * unique_align_paths) {
 
     if (!align_paths.empty()) {
 
         assert(align_paths.size() > 1);
+        assert(align_paths_buffer_queues.size() == align_paths_buffers->size());
 
-        if (align_paths.size() == 2) {
+        const vector<AlignmentPath> * new_align_paths = &align_paths;
 
-            align_paths_buffer->emplace_back(align_paths);
-        
-        } else {
+        if (align_paths.size() > 2) {
 
             auto align_paths_it = align_paths.begin();
             assert(align_paths_it != align_paths.end());
 
-            align_paths_buffer->emplace_back(vector<AlignmentPath>(1, *align_paths_it));
+            unique_align_paths->clear();
+            unique_align_paths->emplace_back(*align_paths_it);
             ++align_paths_it;
 
             while (align_paths_it != align_paths.end()) {
 
-                assert(align_paths_buffer->back().back().is_simple == align_paths_it->is_simple);
-                assert(align_paths_buffer->back().back().min_mapq == align_paths_it->min_mapq);
+                assert(unique_align_paths->back().is_simple == align_paths_it->is_simple);
+                assert(unique_align_paths->back().min_mapq == align_paths_it->min_mapq);
 
-                if (align_paths_buffer->back().back().gbwt_search == align_paths_it->gbwt_search && 
-                    align_paths_buffer->back().back().frag_length == align_paths_it->frag_length) {
+                if (unique_align_paths->back().gbwt_search == align_paths_it->gbwt_search && 
+                    unique_align_paths->back().frag_length == align_paths_it->frag_length) {
 
-                    assert(align_paths_buffer->back().back().align_length > align_paths_it->align_length || 
-                          (align_paths_buffer->back().back().align_length == align_paths_it->align_length && align_paths_buffer->back().back().score_sum >= align_paths_it->score_sum));
+                    assert(unique_align_paths->back().align_length > align_paths_it->align_length || 
+                          (unique_align_paths->back().align_length == align_paths_it->align_length && unique_align_paths->back().score_sum >= align_paths_it->score_sum));
 
                 } else {
 
-                    align_paths_buffer->back().emplace_back(*align_paths_it);
+                    unique_align_paths->emplace_back(*align_paths_it);
                 }
 
                 ++align_paths_it;
             }
 
-            assert(align_paths_buffer->back().size() > 1);
+            assert(unique_align_paths->size() > 1);
+            new_align_paths = unique_align_paths;
+        }
+
+        const uint32_t shard_idx = alignmentPathsIndexShard(*new_align_paths, align_paths_buffers->size());
+
+        auto align_paths_buffer = align_paths_buffers->at(shard_idx);
+        align_paths_buffer->add(*new_align_paths);
+
+        if (align_paths_buffer->isFull()) {
+
+            align_paths_buffer_queues.at(shard_idx)->push(align_paths_buffer);
+            align_paths_buffers->at(shard_idx) = getAlignmentPathsBuffer(align_paths_buffer_pool);
         }
     }
 
@@ -92,85 +277,102 @@ bool addAlignmentPathsToBuffer(const vector<AlignmentPath> & align_paths, vector
 }
 
 template<class AlignmentType> 
-uint32_t findAlignmentPaths(ifstream & alignments_istream, align_paths_buffer_queue_t * align_paths_buffer_queue, const AlignmentPathFinder<AlignmentType> & align_path_finder, const uint32_t num_threads) {
+uint32_t findAlignmentPaths(istream & alignments_istream, const vector<align_paths_buffer_queue_t *> & align_paths_buffer_queues, align_paths_buffer_queue_t * align_paths_buffer_pool, const AlignmentPathFinder<AlignmentType> & align_path_finder, const uint32_t num_threads, const bool dedup_reads, const bool lean_parse, AlignmentStageStats * align_stage_stats) {
 
-    auto threaded_align_paths_buffer = vector<vector<vector<AlignmentPath > > *>(num_threads);
+    auto threaded_align_paths_buffers = vector<vector<AlignmentPathsBuffer *> >(num_threads, vector<AlignmentPathsBuffer *>(align_paths_buffer_queues.size()));
 
-    for (auto & align_paths_buffer: threaded_align_paths_buffer) {
+    for (auto & align_paths_buffers: threaded_align_paths_buffers) {
 
-        align_paths_buffer = new vector<vector<AlignmentPath > >();
-        align_paths_buffer->reserve(align_paths_buffer_size);
+        for (auto & align_paths_buffer: align_paths_buffers) {
+
+            align_paths_buffer = getAlignmentPathsBuffer(align_paths_buffer_pool);
+        }
     }
+
+    vector<vector<AlignmentPath> > threaded_unique_align_paths(num_threads);
   
     vector<uint32_t> threaded_unaligned_read_count(num_threads, 0);
+    vector<AlignmentStageStats> threaded_align_stage_stats(num_threads);
 
-    vg::io::for_each_parallel<AlignmentType>(alignments_istream, [&](AlignmentType & alignment) {
+    vector<dedup_table_t> threaded_dedup_tables(dedup_reads ? num_threads : 0);
+    vector<AlignmentDedupKeyBuilder> threaded_dedup_key_builders(dedup_reads ? num_threads : 0, AlignmentDedupKeyBuilder(AlignmentType::descriptor(), dedup_alignment_fields, lean_alignment_annotation_keys));
 
-        vector<vector<AlignmentPath > > * align_paths_buffer = threaded_align_paths_buffer.at(omp_get_thread_num());
-        
-        if (!addAlignmentPathsToBuffer(align_path_finder.findAlignmentPaths(alignment), align_paths_buffer)) {
+    auto find_align_paths = [&](AlignmentType & alignment) {
 
-            threaded_unaligned_read_count.at(omp_get_thread_num()) += 1;
-        }
+        const double time_find_start = gbwt::readTimer();
 
-        if (align_paths_buffer->size() == align_paths_buffer_size) {
+#ifdef RPVG_READ_STATS
 
-            align_paths_buffer_queue->push(align_paths_buffer);
-            
-            threaded_align_paths_buffer.at(omp_get_thread_num()) = new vector<vector<AlignmentPath > >();
-            threaded_align_paths_buffer.at(omp_get_thread_num())->reserve(align_paths_buffer_size);
-        }
-    });
+        thread_read_costs = ReadCosts();
 
-    for (auto & align_paths_buffer: threaded_align_paths_buffer) {
+#endif
 
-        align_paths_buffer_queue->push(align_paths_buffer);
-    }
+        bool has_align_paths = false;
 
-    uint32_t unaligned_read_count = 0;
+        if (dedup_reads) {
 
-    for (auto & read_count: threaded_unaligned_read_count) {
+            auto & dedup_key_builder = threaded_dedup_key_builders.at(omp_get_thread_num());
 
-        unaligned_read_count += read_count;
-    }
+            dedup_key_builder.clear();
+            dedup_key_builder.addAlignment(alignment);
 
-    return unaligned_read_count;
-}
+            bool is_duplicate = false;
+            has_align_paths = addAlignmentPathsToBuffers(findDedupAlignmentPaths(&(threaded_dedup_tables.at(omp_get_thread_num())), dedup_key_builder.key(), [&]() { return align_path_finder.findAlignmentPaths(alignment); }, &is_duplicate), align_paths_buffer_queues, align_paths_buffer_pool, &(threaded_align_paths_buffers.at(omp_get_thread_num())), &(threaded_unique_align_paths.at(omp_get_thread_num())));
 
-template<class AlignmentType> 
-uint32_t findPairedAlignmentPaths(ifstream & alignments_istream, align_paths_buffer_queue_t * align_paths_buffer_queue, const AlignmentPathFinder<AlignmentType> & align_path_finder, const uint32_t num_threads) {
+            threaded_align_stage_stats.at(omp_get_thread_num()).num_dedup_reads += is_duplicate;
 
-    auto threaded_align_paths_buffer = vector<vector<vector<AlignmentPath > > *>(num_threads);
+        } else {
 
-    for (auto & align_paths_buffer: threaded_align_paths_buffer) {
+            has_align_paths = addAlignmentPathsToBuffers(align_path_finder.findAlignmentPaths(alignment), align_paths_buffer_queues, align_paths_buffer_pool, &(threaded_align_paths_buffers.at(omp_get_thread_num())), &(threaded_unique_align_paths.at(omp_get_thread_num())));
+        }
 
-        align_paths_buffer = new vector<vector<AlignmentPath > >();
-        align_paths_buffer->reserve(align_paths_buffer_size);
-    }
-  
-    vector<uint32_t> threaded_unaligned_read_count(num_threads, 0);
+        if (!has_align_paths) {
+
+            threaded_unaligned_read_count.at(omp_get_thread_num()) += 1;
+        }
 
-    vg::io::for_each_interleaved_pair_parallel<AlignmentType>(alignments_istream, [&](AlignmentType & alignment_1, AlignmentType & alignment_2) {
+        threaded_align_stage_stats.at(omp_get_thread_num()).num_reads += 1;
+        threaded_align_stage_stats.at(omp_get_thread_num()).find_time += gbwt::readTimer() - time_find_start;
 
-        vector<vector<AlignmentPath > > * align_paths_buffer = threaded_align_paths_buffer.at(omp_get_thread_num());
+#ifdef RPVG_READ_STATS
 
-        if (!addAlignmentPathsToBuffer(align_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2), align_paths_buffer)) {
+        thread_read_costs.time = gbwt::readTimer() - time_find_start;
+        threaded_align_stage_stats.at(omp_get_thread_num()).read_stats.add(alignment.name(), thread_read_costs);
 
-            threaded_unaligned_read_count.at(omp_get_thread_num()) += 1;
+#endif
+    };
+
+    // Buffers are handed to the indexing threads before 
+    // errors in the alignments are passed on.
+    string parse_error;
+
+    if (lean_parse) {
+
+        try {
+
+            forEachLeanAlignmentParallel<AlignmentType>(alignments_istream, LeanMessageFilter(AlignmentType::descriptor(), lean_alignment_fields, lean_alignment_annotation_keys), find_align_paths);
+
+        } catch (const runtime_error & e) {
+
+            parse_error = e.what();
         }
 
-        if (align_paths_buffer->size() == align_paths_buffer_size) {
+    } else {
 
-            align_paths_buffer_queue->push(align_paths_buffer);
+        vg::io::for_each_parallel<AlignmentType>(alignments_istream, find_align_paths);
+    }
+
+    for (auto & align_paths_buffers: threaded_align_paths_buffers) {
+
+        for (size_t i = 0; i < align_paths_buffers.size(); ++i) {
 
-            threaded_align_paths_buffer.at(omp_get_thread_num()) = new vector<vector<AlignmentPath > >();
-            threaded_align_paths_buffer.at(omp_get_thread_num())->reserve(align_paths_buffer_size);
+            align_paths_buffer_queues.at(i)->push(align_paths_buffers.at(i));
         }
-    });
+    }
 
-    for (auto & align_paths_buffer: threaded_align_paths_buffer) {
+    if (!parse_error.empty()) {
 
-        align_paths_buffer_queue->push(align_paths_buffer);
+        throw runtime_error(parse_error);
     }
 
     uint32_t unaligned_read_count = 0;
@@ -180,163 +382,197 @@ uint32_t findPairedAlignmentPaths(ifstream & alignments_istream, align_paths_buf
         unaligned_read_count += read_count;
     }
 
+    for (auto & stage_stats: threaded_align_stage_stats) {
+
+        align_stage_stats->num_reads += stage_stats.num_reads;
+        align_stage_stats->find_time += stage_stats.find_time;
+        align_stage_stats->num_dedup_reads += stage_stats.num_dedup_reads;
+
+#ifdef RPVG_READ_STATS
+
+        align_stage_stats->read_stats.merge(stage_stats.read_stats);
+
+#endif
+    }
+
+    align_stage_stats->search_cache_lookups = align_path_finder.searchCacheLookups();
+    align_stage_stats->search_cache_hits = align_path_finder.searchCacheHits();
+
     return unaligned_read_count;
 }
 
-void addAlignmentPathsBufferToIndexes(align_paths_buffer_queue_t * align_paths_buffer_queue, align_paths_index_t * align_paths_index, FragmentLengthDist * frag_length_dist, const FragmentLengthDist & pre_frag_length_dist, const bool is_single_end) {
+template<class AlignmentType> 
+uint32_t findPairedAlignmentPaths(istream & alignments_istream, const vector<align_paths_buffer_queue_t *> & align_paths_buffer_queues, align_paths_buffer_queue_t * align_paths_buffer_pool, const AlignmentPathFinder<AlignmentType> & align_path_finder, const uint32_t num_threads, const bool dedup_reads, const bool lean_parse, AlignmentStageStats * align_stage_stats) {
 
-    vector<vector<AlignmentPath> > * align_paths_buffer = nullptr;
-    vector<uint32_t> frag_length_counts(pre_frag_length_dist.maxLength() + 1, 0);
+    auto threaded_align_paths_buffers = vector<vector<AlignmentPathsBuffer *> >(num_threads, vector<AlignmentPathsBuffer *>(align_paths_buffer_queues.size()));
 
-    while (align_paths_buffer_queue->pop(&align_paths_buffer)) {
+    for (auto & align_paths_buffers: threaded_align_paths_buffers) {
 
-        for (auto & align_paths: *align_paths_buffer) {
+        for (auto & align_paths_buffer: align_paths_buffers) {
 
-            assert(align_paths.size() > 1);
+            align_paths_buffer = getAlignmentPathsBuffer(align_paths_buffer_pool);
+        }
+    }
 
-            assert(align_paths.front().frag_length > 0);
-            assert(align_paths.back().frag_length == 0);
+    vector<vector<AlignmentPath> > threaded_unique_align_paths(num_threads);
+  
+    vector<uint32_t> threaded_unaligned_read_count(num_threads, 0);
+    vector<AlignmentStageStats> threaded_align_stage_stats(num_threads);
 
-            if (!is_single_end && align_paths.front().is_simple && align_paths.front().min_mapq >= frag_length_min_mapq) {
+    vector<dedup_table_t> threaded_dedup_tables(dedup_reads ? num_threads : 0);
+    vector<AlignmentDedupKeyBuilder> threaded_dedup_key_builders(dedup_reads ? num_threads : 0, AlignmentDedupKeyBuilder(AlignmentType::descriptor(), dedup_alignment_fields, lean_alignment_annotation_keys));
 
-                frag_length_counts.at(align_paths.front().frag_length)++;
-            }
+    auto find_paired_align_paths = [&](AlignmentType & alignment_1, AlignmentType & alignment_2) {
 
-            if (align_paths.size() == 2) {       
+        const double time_find_start = gbwt::readTimer();
 
-                align_paths.front().score_sum = 1;       
+#ifdef RPVG_READ_STATS
 
-                align_paths.front().align_length = 1;
-                align_paths.front().frag_length = pre_frag_length_dist.loc();      
-            } 
+        thread_read_costs = ReadCosts();
 
-            auto threaded_align_paths_index_it = align_paths_index->emplace(align_paths, 0);
-            threaded_align_paths_index_it.first->second++;
-        } 
+#endif
 
-        delete align_paths_buffer;
-    }
+        bool has_align_paths = false;
 
-    if (!is_single_end) {
+        if (dedup_reads) {
 
-        *frag_length_dist = FragmentLengthDist(frag_length_counts, true);
-    }
-}
+            auto & dedup_key_builder = threaded_dedup_key_builders.at(omp_get_thread_num());
 
-spp::sparse_hash_map<string, PathInfo> parseHaplotypeTranscriptInfo(const string & filename, const bool parse_haplotype_ids, const bool use_transcript_names) {
+            dedup_key_builder.clear();
+            dedup_key_builder.addAlignment(alignment_1);
+            dedup_key_builder.addAlignment(alignment_2);
 
-    spp::sparse_hash_map<string, PathInfo> haplotype_transcript_info;
+            bool is_duplicate = false;
+            has_align_paths = addAlignmentPathsToBuffers(findDedupAlignmentPaths(&(threaded_dedup_tables.at(omp_get_thread_num())), dedup_key_builder.key(), [&]() { return align_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2); }, &is_duplicate), align_paths_buffer_queues, align_paths_buffer_pool, &(threaded_align_paths_buffers.at(omp_get_thread_num())), &(threaded_unique_align_paths.at(omp_get_thread_num())));
 
-    auto info_file = bgzf_open(filename.c_str(), "r");
+            threaded_align_stage_stats.at(omp_get_thread_num()).num_dedup_reads += is_duplicate;
 
-    uint32_t buffer_size = 65536;
-    uint32_t read_size = 0;
+        } else {
 
-    char * buffer = new char[buffer_size];
+            has_align_paths = addAlignmentPathsToBuffers(align_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2), align_paths_buffer_queues, align_paths_buffer_pool, &(threaded_align_paths_buffers.at(omp_get_thread_num())), &(threaded_unique_align_paths.at(omp_get_thread_num())));
+        }
 
-    spp::sparse_hash_map<string, uint32_t> transcript_id_index;
-    spp::sparse_hash_map<string, uint32_t> haplotype_id_index;
+        if (!has_align_paths) {
 
-    bool is_first_line = true;
-    bool is_old_format = false;
+            threaded_unaligned_read_count.at(omp_get_thread_num()) += 1;
+        }
 
-    stringstream info_sstream;
-    string element;
+        threaded_align_stage_stats.at(omp_get_thread_num()).num_reads += 1;
+        threaded_align_stage_stats.at(omp_get_thread_num()).find_time += gbwt::readTimer() - time_find_start;
 
-    while (true) {
+#ifdef RPVG_READ_STATS
 
-        read_size = bgzf_read(info_file, buffer, buffer_size);
+        thread_read_costs.time = gbwt::readTimer() - time_find_start;
+        threaded_align_stage_stats.at(omp_get_thread_num()).read_stats.add(alignment_1.name(), thread_read_costs);
 
-        if (read_size == 0) {
+#endif
+    };
 
-            break;
-        }
+    // Buffers are handed to the indexing threads before 
+    // errors in the alignments are passed on.
+    string parse_error;
 
-        uint32_t num_lines = 0;
+    if (lean_parse) {
 
-        for (size_t i = 0; i < read_size; ++i) {
+        try {
 
-            info_sstream << buffer[i];
+            forEachLeanInterleavedPairParallel<AlignmentType>(alignments_istream, LeanMessageFilter(AlignmentType::descriptor(), lean_alignment_fields, lean_alignment_annotation_keys), find_paired_align_paths);
 
-            if (buffer[i] == '\n') {
+        } catch (const runtime_error & e) {
 
-                num_lines += 1;
-            }
+            parse_error = e.what();
         }
 
-        if (num_lines == 0) {
+    } else {
 
-            continue;
+        vg::io::for_each_interleaved_pair_parallel<AlignmentType>(alignments_istream, find_paired_align_paths);
+    }
+
+    for (auto & align_paths_buffers: threaded_align_paths_buffers) {
+
+        for (size_t i = 0; i < align_paths_buffers.size(); ++i) {
+
+            align_paths_buffer_queues.at(i)->push(align_paths_buffers.at(i));
         }
+    }
 
-        for (uint32_t l = 0; l < num_lines; ++l) {
+    if (!parse_error.empty()) {
 
-            getline(info_sstream, element, '\t');
+        throw runtime_error(parse_error);
+    }
 
-            if (is_first_line) {
+    uint32_t unaligned_read_count = 0;
 
-                assert(element == "Name");
+    for (auto & read_count: threaded_unaligned_read_count) {
 
-                is_first_line = false;
-                getline(info_sstream, element);
+        unaligned_read_count += read_count;
+    }
 
-                if (element.find("Reference") != std::string::npos ) {
+    for (auto & stage_stats: threaded_align_stage_stats) {
 
-                    is_old_format = true;
-                }
+        align_stage_stats->num_reads += stage_stats.num_reads;
+        align_stage_stats->find_time += stage_stats.find_time;
+        align_stage_stats->num_dedup_reads += stage_stats.num_dedup_reads;
 
-                continue;
-            }
+#ifdef RPVG_READ_STATS
 
-            auto haplotype_transcript_info_it = haplotype_transcript_info.emplace(element, PathInfo(element));
-            assert(haplotype_transcript_info_it.second);
+        align_stage_stats->read_stats.merge(stage_stats.read_stats);
 
-            getline(info_sstream, element, '\t');        
-            getline(info_sstream, element, '\t');
+#endif
+    }
 
-            if (use_transcript_names) {
+    align_stage_stats->search_cache_lookups = align_path_finder.searchCacheLookups();
+    align_stage_stats->search_cache_hits = align_path_finder.searchCacheHits();
 
-                haplotype_transcript_info_it.first->second.name = element;
-            }
+    return unaligned_read_count;
+}
 
-            auto transcript_id_index_it = transcript_id_index.emplace(element, transcript_id_index.size());
-            haplotype_transcript_info_it.first->second.group_id = transcript_id_index_it.first->second;
+void addAlignmentPathsBufferToIndexes(align_paths_buffer_queue_t * align_paths_buffer_queue, align_paths_buffer_queue_t * align_paths_buffer_pool, AlignmentPathsIndex * align_paths_index, vector<uint32_t> * frag_length_counts, const FragmentLengthDist & pre_frag_length_dist, const bool is_single_end, IndexingStageStats * index_stage_stats) {
 
-            if (is_old_format) {
-            
-                getline(info_sstream, element, '\t');
-            }
-            
-            getline(info_sstream, element);
+    AlignmentPathsBuffer * align_paths_buffer = nullptr;
+    assert(frag_length_counts->size() == pre_frag_length_dist.maxLength() + 1);
 
-            if (parse_haplotype_ids) {
+    double time_wait_start = gbwt::readTimer();
 
-                for (auto & haplotype: Utils::splitString(element, ',')) {
+    while (align_paths_buffer_queue->pop(&align_paths_buffer)) {
 
-                    auto haplotype_id_index_it = haplotype_id_index.emplace(haplotype, haplotype_id_index.size());
-                    assert(haplotype_transcript_info_it.first->second.source_ids.emplace(haplotype_id_index_it.first->second).second);
-                }
+        const double time_index_start = gbwt::readTimer();
+        index_stage_stats->wait_time += time_index_start - time_wait_start;
 
-                haplotype_transcript_info_it.first->second.source_count = haplotype_transcript_info_it.first->second.source_ids.size();
+        for (uint32_t i = 0; i < align_paths_buffer->num_align_paths; ++i) {
 
-            } else {
+            auto & align_paths = align_paths_buffer->align_paths.at(i);
+
+            assert(align_paths.size() > 1);
+
+            assert(align_paths.front().frag_length > 0);
+            assert(align_paths.back().frag_length == 0);
+
+            if (!is_single_end && align_paths.front().is_simple && align_paths.front().min_mapq >= frag_length_min_mapq) {
 
-                haplotype_transcript_info_it.first->second.source_count = count(element.begin(), element.end(), ',') + 1;
+                frag_length_counts->at(align_paths.front().frag_length)++;
             }
-        }
 
-        getline(info_sstream, element);
+            if (align_paths.size() == 2) {       
 
-        info_sstream.clear();
-        info_sstream.str("");
+                align_paths.front().score_sum = 1;       
 
-        info_sstream << element;
-    }
+                align_paths.front().align_length = 1;
+                align_paths.front().frag_length = pre_frag_length_dist.loc();      
+            } 
 
-    delete[] buffer;
+            align_paths_index->add(align_paths, 1);
+        } 
+
+        returnAlignmentPathsBuffer(align_paths_buffer, align_paths_buffer_pool);
+
+        time_wait_start = gbwt::readTimer();
 
-    assert(bgzf_close(info_file) == 0);
-    return haplotype_transcript_info;
+        index_stage_stats->num_buffers++;
+        index_stage_stats->index_time += time_wait_start - time_index_start;
+    }
+
+    index_stage_stats->wait_time += gbwt::readTimer() - time_wait_start;
 }
 
 // https://stackoverflow.com/questions/12774207/fastest-way-to-check-if-a-file-exist-using-standard-c-c11-c
@@ -346,20 +582,31 @@ bool doesFileExist(const string name) {
     return (stat(name.c_str(), &buffer) == 0); 
 }
 
-int main(int argc, char* argv[]) {
+bool isRegularFile(const string name) {
+
+    struct stat buffer;
+    return (stat(name.c_str(), &buffer) == 0 && S_ISREG(buffer.st_mode)); 
+}
+
+cxxopts::Options createOptions() {
 
     cxxopts::Options options("rpvg", "rpvg - infers path posterior probabilities and abundances from variation graph read alignments");
 
     options.add_options("Required")
-      ("g,graph", "xg graph filename", cxxopts::value<string>())
+      ("g,graph", "xg graph or node length (--write-node-lengths output) filename", cxxopts::value<string>())
       ("p,paths", "GBWT index filename", cxxopts::value<string>())
-      ("a,alignments", "gam(p) alignment filename", cxxopts::value<string>())
+      ("a,alignments", "gam(p) alignment filename (use - for stdin)", cxxopts::value<string>())
       ("o,output-prefix", "prefix used for output filenames (e.g. <prefix>.txt)", cxxopts::value<string>())
       ("i,inference-model", "inference model to use (haplotypes, transcripts, strains or haplotype-transcripts)", cxxopts::value<string>())
       ;
 
     options.add_options("General")
       ("t,threads", "number of compute threads (+= 1 I/O thread)", cxxopts::value<uint32_t>()->default_value("1"))
+      ("server", "run as resident server that keeps the graph and indexes loaded and accepts jobs on a UNIX socket (see README)", cxxopts::value<string>())
+      ("server-jobs", "maximum number of jobs run concurrently by the server (--server)", cxxopts::value<uint32_t>()->default_value("1"))
+      ("write-node-lengths", "write node lengths to file (<prefix>_node_lengths.bin), which can be used instead of the graph (-g)", cxxopts::value<bool>())
+      ("write-node-clusters", "write clusters of paths sharing a node to file (<paths>.ncl), which is loaded in later runs instead of clustering these paths again", cxxopts::value<bool>())
+      ("decomp-threads", "number of threads used for decompressing alignments (default: --threads)", cxxopts::value<uint32_t>())
       ("r,rng-seed", "seed for random number generator (default: unix time)", cxxopts::value<uint64_t>())
       ("h,help", "print help", cxxopts::value<bool>())
       ;
@@ -370,6 +617,11 @@ int main(int argc, char* argv[]) {
       ("s,single-end", "alignment input is single-end reads", cxxopts::value<bool>())
       ("l,long-reads", "alignment input is single-molecule long reads (single-end only)", cxxopts::value<bool>())
       ("score-not-qual", "alignment score is not quality adjusted", cxxopts::value<bool>())
+      ("pair-dist-index", "build node distance index used to prune paired-end path search (increases index memory)", cxxopts::value<bool>())
+      ("lean-parse", "only parse the alignment fields used for finding alignment paths", cxxopts::value<bool>())
+      ("dedup-reads", "reuse alignment paths of recently seen identical reads (e.g. PCR duplicates)", cxxopts::value<bool>())
+      ("write-align-paths", "write alignment path index to file (<prefix>_align_paths.bin)", cxxopts::value<bool>())
+      ("load-align-paths", "load alignment path index (--write-align-paths output) instead of alignments", cxxopts::value<string>())
       ;
 
     options.add_options("Fragment")
@@ -393,6 +645,7 @@ int main(int argc, char* argv[]) {
     options.add_options("Haplotyping")
       ("y,ploidy", "max sample ploidy", cxxopts::value<uint32_t>()->default_value("2"))
       ("f,path-info", "path haplotype/transcript info filename (required for haplotype-transcript inference)", cxxopts::value<string>())
+      ("write-path-info-bin", "write binary path info table (<path-info>.bin) that is loaded instead of --path-info in later runs", cxxopts::value<bool>())
       ("min-hap-prob", "minimum haplotyping probability in haplotype-transcript inference", cxxopts::value<double>()->default_value("0.001"))
       ("ind-hap-inference", "infer haplotypes independently for each transcript in haplotype-transcript inference", cxxopts::value<bool>())
       ("use-hap-gibbs", "use Gibbs sampling for haplotype inference", cxxopts::value<bool>())
@@ -405,63 +658,112 @@ int main(int argc, char* argv[]) {
       ("gibbs-thin-its", "number of Gibbs iterations between samples", cxxopts::value<uint32_t>()->default_value("25"))      
       ;
 
-    if (argc == 1) {
+    return options;
+}
 
-        cerr << options.help({"Required", "General", "Alignment", "Fragment", "Probability", "Haplotyping", "Quantification"}) << endl;
-        return 1;
-    }
- 
-    auto option_results = options.parse(argc, argv);
+// Checks the options that are given for each sample (alignments, output
+// and inference) before any indexes are loaded.
+bool checkQuantificationOptions(const cxxopts::ParseResult & option_results, const string & log_prefix) {
 
-    if (option_results.count("help")) {
+    if (!option_results.count("alignments") && !option_results.count("load-align-paths")) {
 
-        cerr << options.help({"Required", "General", "Alignment", "Fragment", "Probability", "Haplotyping", "Quantification"}) << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Alignments (gam or gamp format) input required (--alignments)." << endl;
+        return false;
     }
 
-    if (!option_results.count("graph")) {
+    if (option_results.count("alignments") && option_results.count("load-align-paths")) {
 
-        cerr << "ERROR: Graph (xg format) input required (--graph)." << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Alignments (--alignments) and alignment path index (--load-align-paths) can not both be given as input." << endl;
+        return false;
     }
 
-    if (!option_results.count("paths")) {
+    if (option_results.count("alignments") && option_results["alignments"].as<string>() != "-" && !doesFileExist(option_results["alignments"].as<string>())) {
 
-        cerr << "ERROR: Paths (GBWT index) input required (--paths)." << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Alignment file (--alignments " << option_results["alignments"].as<string>() << ") does not exist." << endl;
+        return false;
     }
 
-    if (!option_results.count("alignments")) {
+    if (option_results.count("load-align-paths") && !doesFileExist(option_results["load-align-paths"].as<string>())) {
 
-        cerr << "ERROR: Alignments (gam or gamp format) input required (--alignments)." << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Alignment path index file (--load-align-paths " << option_results["load-align-paths"].as<string>() << ") does not exist." << endl;
+        return false;
     }
 
     if (!option_results.count("output-prefix")) {
 
-        cerr << "ERROR: Prefix used for output filenames required (--output-prefix)." << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Prefix used for output filenames required (--output-prefix)." << endl;
+        return false;
     }
 
     if (!option_results.count("inference-model")) {
 
-        cerr << "ERROR: Inference model required (--inference-model). Options: haplotypes, transcripts, strains or haplotype-transcripts." << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Inference model required (--inference-model). Options: haplotypes, transcripts, strains or haplotype-transcripts." << endl;
+        return false;
     }
 
     const string inference_model = option_results["inference-model"].as<string>();
 
     if (inference_model != "haplotypes" && inference_model != "transcripts" && inference_model != "strains" && inference_model != "haplotype-transcripts") {
 
-        cerr << "ERROR: Inference model provided (--inference-model) not supported. Options: haplotypes, transcripts, strains or haplotype-transcripts." << endl;
-        return 1;
+        cerr << log_prefix << "ERROR: Inference model provided (--inference-model) not supported. Options: haplotypes, transcripts, strains or haplotype-transcripts." << endl;
+        return false;
+    }
+
+    const string library_type = option_results["strand-specific"].as<string>();
+
+    if (library_type != "unstranded" && library_type != "fr" && library_type != "rf") {
+
+        cerr << log_prefix << "ERROR: Strand-specific library type provided (--strand-specific) not supported. Options: unstranded, fr or rf." << endl;
+        return false;
+    }
+
+    if (option_results.count("frag-mean") != option_results.count("frag-sd")) {
+
+        cerr << log_prefix << "ERROR: Both --frag-mean and --frag-sd needs to be given as input. Alternative, no values can be given for paired-end, non-long read alignments and the parameter estimated during mapping will be used instead (contained in the alignment file)." << endl;
+        return false;
+    }
+
+    if (!option_results.count("load-align-paths") && !option_results.count("long-reads") && !option_results.count("frag-mean") && option_results.count("single-end")) {
+
+        cerr << log_prefix << "ERROR: Both --frag-mean and --frag-sd needs to be given as input when using single-end, short read alignments." << endl;
+        return false;            
+    }
+
+    if (option_results["ploidy"].as<uint32_t>() == 0) {
+
+        cerr << log_prefix << "ERROR: Ploidy (--ploidy) can not be 0." << endl;
+        return false;        
     }
 
+    if (inference_model == "haplotype-transcripts" && !option_results.count("path-info")) {
+
+        cerr << log_prefix << "ERROR: Path haplotype/transcript information file (--path-info) needed when running in haplotype-transcripts inference mode (--write-info output from vg rna)." << endl;
+        return false;
+    }
+
+    if (option_results.count("path-info") && !doesFileExist(option_results["path-info"].as<string>())) {
+
+        cerr << log_prefix << "ERROR: Path haplotype/transcript information file (--path-info " << option_results["path-info"].as<string>() << ") does not exist." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Runs the alignment, clustering and estimation pipeline for a single 
+// sample. The paths index is only read and can be shared between jobs.
+int runQuantification(const cxxopts::ParseResult & option_results, const PathsIndex & paths_index, const string & log_prefix) {
+
+    const string inference_model = option_results["inference-model"].as<string>();
+
     const uint32_t num_threads = option_results["threads"].as<uint32_t>();
     assert(num_threads > 0);
 
     omp_set_num_threads(num_threads);
 
+    const uint32_t num_decomp_threads = option_results.count("decomp-threads") ? option_results["decomp-threads"].as<uint32_t>() : num_threads;
+    assert(num_decomp_threads > 0);
+
     uint64_t rng_seed = 0; 
 
     if (option_results.count("rng-seed")) {
@@ -473,71 +775,122 @@ int main(int argc, char* argv[]) {
         rng_seed = time(nullptr);
     }
 
-
-    cerr << "Running rpvg (commit: " << GIT_COMMIT << ")" << endl;
-    cerr << "Random number generator seed: " << rng_seed << endl;
+    cerr << log_prefix << "Random number generator seed: " << rng_seed << endl;
 
     const string library_type = option_results["strand-specific"].as<string>();
 
-    if (library_type != "unstranded" && library_type != "fr" && library_type != "rf") {
-
-        cerr << "ERROR: Strand-specific library type provided (--strand-specific) not supported. Options: unstranded, fr or rf." << endl;
-        return 1;
-    }
-
     const bool is_single_end = (option_results.count("single-end") || option_results.count("long-reads"));
     const bool is_long_reads = option_results.count("long-reads");
     const bool is_single_path = option_results.count("single-path");
+    const bool load_align_paths = option_results.count("load-align-paths");
 
     const uint32_t max_num_sd_frag = option_results["max-num-sd-frag"].as<uint32_t>();
     assert(max_num_sd_frag > 0);
 
-    if (option_results.count("frag-mean") != option_results.count("frag-sd")) {
+    // Alignments from stdin or named pipes are read in a single pass. Any 
+    // records read while searching for the fragment length distribution 
+    // parameters are replayed for the main pass. Regular files are instead 
+    // searched using a separate stream, which has no recording limit.
+    const bool is_alignments_file_regular = !load_align_paths && isRegularFile(option_results["alignments"].as<string>());
 
-        cerr << "ERROR: Both --frag-mean and --frag-sd needs to be given as input. Alternative, no values can be given for paired-end, non-long read alignments and the parameter estimated during mapping will be used instead (contained in the alignment file)." << endl;
-        return 1;
+    unique_ptr<BgzfInputBuffer> alignments_bgzf_buffer;
+    unique_ptr<RewindableInputBuffer> alignments_buffer;
+
+    istream alignments_istream(nullptr);
+
+    if (!load_align_paths) {
+
+        alignments_bgzf_buffer.reset(new BgzfInputBuffer(option_results["alignments"].as<string>(), num_decomp_threads));
+
+        if (!alignments_bgzf_buffer->isOpen()) {
+
+            cerr << log_prefix << "ERROR: Could not open alignment file (--alignments " << option_results["alignments"].as<string>() << ")." << endl;
+            return 1;
+        }
+
+        if (is_alignments_file_regular) {
+
+            alignments_istream.rdbuf(alignments_bgzf_buffer.get());
+
+        } else {
+
+            alignments_buffer.reset(new RewindableInputBuffer(alignments_bgzf_buffer.get(), max_frag_length_search_bytes));
+            alignments_istream.rdbuf(alignments_buffer.get());
+        }
     }
 
     FragmentLengthDist pre_frag_length_dist; 
 
-    if (is_long_reads) {
+    // Fragment length distribution parameters given together with an alignment 
+    // path index are only used to check that they match the index.
+    if (load_align_paths && !is_long_reads && !option_results.count("frag-mean")) {
+
+        cerr << log_prefix << "Fragment length distribution parameters will be loaded from alignment path index" << endl;
+
+    } else if (is_long_reads) {
 
         assert(is_single_end);
         pre_frag_length_dist = FragmentLengthDist(1, 1, max_num_sd_frag);
 
     } else if (!option_results.count("frag-mean") && !option_results.count("frag-sd")) {
 
-        if (is_single_end) {
+        assert(!is_single_end);
 
-            cerr << "ERROR: Both --frag-mean and --frag-sd needs to be given as input when using single-end, short read alignments." << endl;
-            return 1;            
-        }
+        if (is_alignments_file_regular) {
+
+            ifstream frag_alignments_istream(option_results["alignments"].as<string>());
 
-        ifstream frag_alignments_istream(option_results["alignments"].as<string>());
-        assert(frag_alignments_istream.is_open());
+            if (!frag_alignments_istream.is_open()) {
 
-        pre_frag_length_dist = FragmentLengthDist(&frag_alignments_istream, !is_single_path, max_num_sd_frag);
+                cerr << log_prefix << "ERROR: Could not open alignment file (--alignments " << option_results["alignments"].as<string>() << ")." << endl;
+                return 1;
+            }
+
+            pre_frag_length_dist = FragmentLengthDist(&frag_alignments_istream, !is_single_path, max_num_sd_frag);
+            frag_alignments_istream.close();
+
+        } else {
 
-        frag_alignments_istream.close();
+            try {
+
+                pre_frag_length_dist = FragmentLengthDist(&alignments_istream, !is_single_path, max_num_sd_frag);
+
+            } catch (const runtime_error & e) {
+
+                // Parsing fails if the recording limit truncates a message.
+                if (!alignments_buffer->recordingLimitReached()) {
+
+                    throw;
+                }
+            }
+
+            if (alignments_buffer->recordingLimitReached()) {
+
+                cerr << log_prefix << "ERROR: No fragment length distribution parameters found in the first " << gbwt::inGigabytes(max_frag_length_search_bytes) << " GB of alignments from stdin or pipe. Use --frag-mean and --frag-sd instead." << endl;
+                return 1;
+            }
+        }
 
         if (!pre_frag_length_dist.isValid()) {
 
-            cerr << "ERROR: No fragment length distribution parameters found in alignments. Use --frag-mean and --frag-sd instead." << endl;
+            cerr << log_prefix << "ERROR: No fragment length distribution parameters found in alignments. Use --frag-mean and --frag-sd instead." << endl;
             return 1;
         
         } else {
 
-            cerr << "Fragment length distribution parameters found in alignment (mean: " << pre_frag_length_dist.loc() << ", standard deviation: " << pre_frag_length_dist.scale() << ")" << endl;
+            cerr << log_prefix << "Fragment length distribution parameters found in alignment (mean: " << pre_frag_length_dist.loc() << ", standard deviation: " << pre_frag_length_dist.scale() << ")" << endl;
         }      
 
     } else {
 
         pre_frag_length_dist = FragmentLengthDist(option_results["frag-mean"].as<double>(), option_results["frag-sd"].as<double>(), max_num_sd_frag);
 
-        cerr << "Fragment length distribution parameters given as input (mean: " << pre_frag_length_dist.loc() << ", standard deviation: " << pre_frag_length_dist.scale() << ")" << endl;
+        cerr << log_prefix << "Fragment length distribution parameters given as input (mean: " << pre_frag_length_dist.loc() << ", standard deviation: " << pre_frag_length_dist.scale() << ")" << endl;
     }
 
     const bool score_not_qual = option_results.count("score-not-qual");
+    const bool dedup_reads = option_results.count("dedup-reads");
+    const bool lean_parse = option_results.count("lean-parse");
 
     const uint32_t max_partial_offset = option_results["max-par-offset"].as<uint32_t>();
     
@@ -560,232 +913,367 @@ int main(int argc, char* argv[]) {
 
     const uint32_t ploidy = option_results["ploidy"].as<uint32_t>();
 
-    if (ploidy == 0) {
+    const bool collapse_haps = (inference_model == "transcripts" && option_results.count("path-info"));
+    
+    assert(load_align_paths || pre_frag_length_dist.isValid());
 
-        cerr << "ERROR: Ploidy (--ploidy) can not be 0." << endl;
-        return 1;        
-    }
+    const double min_hap_prob = option_results["min-hap-prob"].as<double>();
+    assert(min_hap_prob > 0 && min_hap_prob <= 1);
 
-    if (inference_model == "haplotype-transcripts" && !option_results.count("path-info")) {
+    const bool ind_hap_inference = option_results.count("ind-hap-inference");
+    const bool use_hap_gibbs = option_results.count("use-hap-gibbs");
 
-        cerr << "ERROR: Path haplotype/transcript information file (--path-info) needed when running in haplotype-transcripts inference mode (--write-info output from vg rna)." << endl;
-        return 1;
-    }
+    const uint32_t num_gibbs_samples = option_results["num-gibbs-samples"].as<uint32_t>();
+    const uint32_t max_em_its = option_results["max-em-its"].as<uint32_t>();
 
-    if (option_results.count("path-info") && !doesFileExist(option_results["path-info"].as<string>())) {
+    const double max_rel_em_conv = option_results["max-rel-em-conv"].as<double>();
+    assert(max_rel_em_conv > 0 && max_rel_em_conv <= 1);
+
+    const uint32_t gibbs_thin_its = option_results["gibbs-thin-its"].as<uint32_t>();
+
+    double time_start = gbwt::readTimer();
+
+    AlignmentPathsIndex align_paths_index;
+    uint32_t unaligned_read_count = 0;
+
+    FragmentLengthDist frag_length_dist;
+    AlignmentPathsCache align_paths_cache(paths_index, is_single_end, is_long_reads, library_type, is_single_path, score_not_qual, use_allelic_mapq, max_partial_offset, max_score_diff, min_best_score_filter, pre_frag_length_dist);
+
+    if (load_align_paths) {
+
+        ifstream align_paths_istream(option_results["load-align-paths"].as<string>(), ios::binary);
+
+        if (!align_paths_istream.is_open()) {
+
+            cerr << log_prefix << "ERROR: Could not open alignment path index file (--load-align-paths " << option_results["load-align-paths"].as<string>() << ")." << endl;
+            return 1;
+        }
+
+        if (!align_paths_cache.load(align_paths_istream, &align_paths_index, &frag_length_dist, &unaligned_read_count)) {
+
+            cerr << log_prefix << "ERROR: Alignment path index (--load-align-paths) is not compatible with the given GBWT index, read type options, alignment path options, fragment length distribution parameters or version of rpvg." << endl;
+            return 1;
+        }
+
+        align_paths_istream.close();
+
+        cerr << log_prefix << "Fragment length distribution parameters loaded from alignment path index (location: " << frag_length_dist.loc() << ", scale: " << frag_length_dist.scale() << ", shape: " << frag_length_dist.shape() << ")" << endl;
+
+    } else {
+
+        if (alignments_buffer) {
+
+            alignments_buffer->rewind();
+        }
+
+        alignments_istream.clear();
+
+        AlignmentStageStats align_stage_stats;
+        const double time_stage_start = gbwt::readTimer();
+
+        // The alignment path index is partitioned into shards that are 
+        // each built by a separate indexing thread and merged afterwards.
+        const uint32_t num_align_paths_index_shards = (num_threads + num_threads_per_align_paths_index_shard - 1) / num_threads_per_align_paths_index_shard;
+
+        vector<align_paths_buffer_queue_t *> align_paths_buffer_queues(num_align_paths_index_shards);
+
+        // Consumed buffers are returned to the producers through a bounded pool.
+        auto align_paths_buffer_pool = new align_paths_buffer_queue_t(num_align_paths_index_shards * num_threads * 4);
+
+        vector<AlignmentPathsIndex> sharded_align_paths_index(num_align_paths_index_shards);
+        vector<vector<uint32_t> > sharded_frag_length_counts(num_align_paths_index_shards, vector<uint32_t>(pre_frag_length_dist.maxLength() + 1, 0));
+        vector<IndexingStageStats> sharded_index_stage_stats(num_align_paths_index_shards);
+
+        vector<thread> indexing_threads;
+        indexing_threads.reserve(num_align_paths_index_shards);
+
+        for (uint32_t i = 0; i < num_align_paths_index_shards; ++i) {
+
+            align_paths_buffer_queues.at(i) = new align_paths_buffer_queue_t(num_threads * 3);
+            indexing_threads.emplace_back(addAlignmentPathsBufferToIndexes, align_paths_buffer_queues.at(i), align_paths_buffer_pool, &(sharded_align_paths_index.at(i)), &(sharded_frag_length_counts.at(i)), pre_frag_length_dist, is_single_end, &(sharded_index_stage_stats.at(i)));
+        }
+
+        // Errors in the alignments are reported once the indexing 
+        // threads have finished.
+        string find_error;
+
+        try {
+
+            if (is_single_path) {
+        
+                AlignmentPathFinder<vg::Alignment> align_path_finder(paths_index, num_threads, library_type, score_not_qual, use_allelic_mapq, pre_frag_length_dist.maxLength(), max_partial_offset, est_missing_noise_prob, max_score_diff, min_best_score_filter);
+
+                if (is_single_end) {
+
+                    unaligned_read_count = findAlignmentPaths<vg::Alignment>(alignments_istream, align_paths_buffer_queues, align_paths_buffer_pool, align_path_finder, num_threads, dedup_reads, lean_parse, &align_stage_stats);
+
+                } else {
+
+                    unaligned_read_count = findPairedAlignmentPaths<vg::Alignment>(alignments_istream, align_paths_buffer_queues, align_paths_buffer_pool, align_path_finder, num_threads, dedup_reads, lean_parse, &align_stage_stats);
+                }
+
+            } else {
+
+                AlignmentPathFinder<vg::MultipathAlignment> align_path_finder(paths_index, num_threads, library_type, score_not_qual, use_allelic_mapq, pre_frag_length_dist.maxLength(), max_partial_offset, est_missing_noise_prob, max_score_diff, min_best_score_filter);
+
+                if (is_single_end) {
+
+                    unaligned_read_count = findAlignmentPaths<vg::MultipathAlignment>(alignments_istream, align_paths_buffer_queues, align_paths_buffer_pool, align_path_finder, num_threads, dedup_reads, lean_parse, &align_stage_stats);
+
+                } else {
+
+                    unaligned_read_count = findPairedAlignmentPaths<vg::MultipathAlignment>(alignments_istream, align_paths_buffer_queues, align_paths_buffer_pool, align_path_finder, num_threads, dedup_reads, lean_parse, &align_stage_stats);
+                }        
+            }
+
+        } catch (const runtime_error & e) {
+
+            find_error = e.what();
+        }
+
+        alignments_istream.rdbuf(nullptr);
+        alignments_buffer.reset();
+
+        const double time_stage = gbwt::readTimer() - time_stage_start;
+
+        for (uint32_t i = 0; i < num_align_paths_index_shards; ++i) {
+
+            align_paths_buffer_queues.at(i)->pushedLast();
+
+            indexing_threads.at(i).join();
+            delete align_paths_buffer_queues.at(i);
+        }
+
+        AlignmentPathsBuffer * align_paths_buffer = nullptr;
 
-        cerr << "ERROR: Path haplotype/transcript information file (--path-info " << option_results["path-info"].as<string>() << ") does not exist." << endl;
-        return 1;
-    }
+        while (align_paths_buffer_pool->tryPop(&align_paths_buffer)) {
 
-    const bool collapse_haps = (inference_model == "transcripts" && option_results.count("path-info"));
-    
-    assert(pre_frag_length_dist.isValid());
+            delete align_paths_buffer;
+        }
 
-    const double min_hap_prob = option_results["min-hap-prob"].as<double>();
-    assert(min_hap_prob > 0 && min_hap_prob <= 1);
+        delete align_paths_buffer_pool;
 
-    const bool ind_hap_inference = option_results.count("ind-hap-inference");
-    const bool use_hap_gibbs = option_results.count("use-hap-gibbs");
+        if (!find_error.empty()) {
 
-    const uint32_t num_gibbs_samples = option_results["num-gibbs-samples"].as<uint32_t>();
-    const uint32_t max_em_its = option_results["max-em-its"].as<uint32_t>();
+            cerr << log_prefix << "ERROR: Could not read alignments (" << find_error << ")." << endl;
+            return 1;
+        }
 
-    const double max_rel_em_conv = option_results["max-rel-em-conv"].as<double>();
-    assert(max_rel_em_conv > 0 && max_rel_em_conv <= 1);
+        IndexingStageStats index_stage_stats;
 
-    const uint32_t gibbs_thin_its = option_results["gibbs-thin-its"].as<uint32_t>();
+        for (auto & stage_stats: sharded_index_stage_stats) {
 
-    double time_init = gbwt::readTimer();
+            index_stage_stats.num_buffers += stage_stats.num_buffers;
+            index_stage_stats.index_time += stage_stats.index_time;
+            index_stage_stats.wait_time += stage_stats.wait_time;
+        }
 
-    assert(vg::io::register_libvg_io());
+        cerr << log_prefix << "Decompressed " << gbwt::inGigabytes(alignments_bgzf_buffer->decompressedBytes()) << " GB of " << (alignments_bgzf_buffer->isCompressed() ? "compressed" : "uncompressed") << " alignments in " << alignments_bgzf_buffer->numFills() << " buffer fills using " << num_decomp_threads << " threads (" << gbwt::inGigabytes(alignments_bgzf_buffer->decompressedBytes()) / time_stage << " GB/s, " << alignments_bgzf_buffer->decompressionTime() << " seconds waiting on decompression)" << endl;
+        cerr << log_prefix << "Parsed " << align_stage_stats.num_reads << " reads" << (is_single_end ? "" : " pairs") << " (" << align_stage_stats.num_reads / time_stage << " per second, " << align_stage_stats.find_time / num_threads << " seconds finding paths per thread)" << endl;
+        cerr << log_prefix << "Indexed " << index_stage_stats.num_buffers << " alignment path buffers using " << num_align_paths_index_shards << " threads (" << index_stage_stats.index_time / num_align_paths_index_shards << " seconds indexing and " << index_stage_stats.wait_time / num_align_paths_index_shards << " seconds waiting on buffers per thread)" << endl;
+        if (dedup_reads) {
 
-    unique_ptr<handlegraph::HandleGraph> graph = vg::io::VPKG::load_one<handlegraph::HandleGraph>(option_results["graph"].as<string>());
-    unique_ptr<gbwt::GBWT> gbwt_index = vg::io::VPKG::load_one<gbwt::GBWT>(option_results["paths"].as<string>());
+            cerr << log_prefix << "Reused alignment paths for " << align_stage_stats.num_dedup_reads << " duplicate reads" << (is_single_end ? "" : " pairs") << endl;
+        }
 
-    unique_ptr<gbwt::FastLocate> r_index;
+        cerr << log_prefix << "GBWT search cache answered " << align_stage_stats.search_cache_hits << " of " << align_stage_stats.search_cache_lookups << " extensions (" << align_stage_stats.search_cache_hits / static_cast<double>(max(align_stage_stats.search_cache_lookups, static_cast<uint64_t>(1))) * 100 << "% hit rate)" << endl;
 
-    if (doesFileExist(option_results["paths"].as<string>() + ".ri")) {
+#ifdef RPVG_READ_STATS
 
-        r_index = move(vg::io::VPKG::load_one<gbwt::FastLocate>(option_results["paths"].as<string>() + ".ri"));
-        r_index->setGBWT(*gbwt_index);        
+        ofstream read_stats_ostream(option_results["output-prefix"].as<string>() + "_read_stats.txt");
 
-    } else {
+        if (!read_stats_ostream.is_open()) {
 
-        r_index = std::make_unique<gbwt::FastLocate>();
-    }
+            cerr << log_prefix << "ERROR: Could not write read cost statistics file (" << option_results["output-prefix"].as<string>() << "_read_stats.txt)." << endl;
+            return 1;
+        }
 
-    PathsIndex paths_index(*gbwt_index, *r_index, *graph);
-    graph.reset(nullptr);
+        align_stage_stats.read_stats.writeReport(read_stats_ostream);
+        read_stats_ostream.close();
 
-    if (paths_index.numberOfPaths() == 0) {
+        cerr << log_prefix << "Wrote read cost statistics for " << align_stage_stats.read_stats.numReads() << " reads" << (is_single_end ? "" : " pairs") << " to " << option_results["output-prefix"].as<string>() << "_read_stats.txt" << endl;
 
-        cerr << "ERROR: The GBWT index does not contain any paths." << endl;
-        return 1;        
-    }
+#endif
 
-    double time_load = gbwt::readTimer();
+        alignments_bgzf_buffer.reset();
 
-    if (r_index->empty()) {
+        // Identical alignment paths are assigned to the same shard
+        // and the shards can therefore be merged without collisions.
+        align_paths_index = move(sharded_align_paths_index.front());
 
-        cerr << "Loaded graph and GBWT (" << time_load - time_init << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
+        vector<uint32_t> frag_length_counts = move(sharded_frag_length_counts.front());
 
-    } else {
+        for (uint32_t i = 1; i < num_align_paths_index_shards; ++i) {
 
-        cerr << "Loaded graph, GBWT and r-index (" << time_load - time_init << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;        
-    }
+            align_paths_index.merge(&(sharded_align_paths_index.at(i)));
 
-    ifstream alignments_istream(option_results["alignments"].as<string>());
-    assert(alignments_istream.is_open());
+            assert(frag_length_counts.size() == sharded_frag_length_counts.at(i).size());
 
-    align_paths_index_t align_paths_index;
-    auto align_paths_buffer_queue = new align_paths_buffer_queue_t(num_threads * 3);
+            for (size_t j = 0; j < frag_length_counts.size(); ++j) {
 
-    uint32_t unaligned_read_count = 0;
+                frag_length_counts.at(j) += sharded_frag_length_counts.at(i).at(j);
+            }
+        }
 
-    FragmentLengthDist frag_length_dist;
-    thread indexing_thread(addAlignmentPathsBufferToIndexes, align_paths_buffer_queue, &align_paths_index, &frag_length_dist, pre_frag_length_dist, is_single_end);
+        if (!is_single_end) {
 
-    if (is_single_path) {
-        
-        AlignmentPathFinder<vg::Alignment> align_path_finder(paths_index, library_type, score_not_qual, use_allelic_mapq, pre_frag_length_dist.maxLength(), max_partial_offset, est_missing_noise_prob, max_score_diff, min_best_score_filter);
+            frag_length_dist = FragmentLengthDist(frag_length_counts, true);
+        }
 
-        if (is_single_end) {
+        if (is_single_end || is_long_reads) {
 
-            unaligned_read_count = findAlignmentPaths<vg::Alignment>(alignments_istream, align_paths_buffer_queue, align_path_finder, num_threads);
+            frag_length_dist = pre_frag_length_dist;
 
         } else {
 
-            unaligned_read_count = findPairedAlignmentPaths<vg::Alignment>(alignments_istream, align_paths_buffer_queue, align_path_finder, num_threads);
-        }
+            if (!frag_length_dist.isValid()) {
 
-    } else {
+                if (option_results.count("frag-mean") && option_results.count("frag-sd")) {
 
-        AlignmentPathFinder<vg::MultipathAlignment> align_path_finder(paths_index, library_type, score_not_qual, use_allelic_mapq, pre_frag_length_dist.maxLength(), max_partial_offset, est_missing_noise_prob, max_score_diff, min_best_score_filter);
+                    cerr << log_prefix << "Warning: Too few unambiguous read pairs available to re-estimate fragment length distribution parameters from alignment paths. Will use parameters given as input instead (mean: " << pre_frag_length_dist.loc() << ", standard deviation: " << pre_frag_length_dist.scale() << ")" << endl;
 
-        if (is_single_end) {
+                    frag_length_dist = pre_frag_length_dist;
 
-            unaligned_read_count = findAlignmentPaths<vg::MultipathAlignment>(alignments_istream, align_paths_buffer_queue, align_path_finder, num_threads);
+                } else {
 
-        } else {
+                    cerr << log_prefix << "Error: Too few unambiguous read pairs available to re-estimate fragment length distribution parameters from alignment paths. Use --frag-mean and --frag-sd instead." << endl;
+                    return 1;
+                }
+        
+            } else {
 
-            unaligned_read_count = findPairedAlignmentPaths<vg::MultipathAlignment>(alignments_istream, align_paths_buffer_queue, align_path_finder, num_threads);
-        }        
+                cerr << log_prefix << "Fragment length distribution parameters re-estimated from alignment paths (location: " << frag_length_dist.loc() << ", scale: " << frag_length_dist.scale() << ", shape: " << frag_length_dist.shape() << ")" << endl;
+            }
+        }
     }
 
-    alignments_istream.close();
-    align_paths_buffer_queue->pushedLast();
-
-    indexing_thread.join();
-    delete align_paths_buffer_queue;
+    double time_align = gbwt::readTimer();
 
-    if (is_single_end || is_long_reads) {
+    if (load_align_paths) {
 
-        frag_length_dist = pre_frag_length_dist;
+        cerr << log_prefix << "Loaded alignment paths (" << time_align - time_start << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
 
     } else {
 
-        if (!frag_length_dist.isValid()) {
-
-            if (option_results.count("frag-mean") && option_results.count("frag-sd")) {
+        cerr << log_prefix << "Found alignment paths (" << time_align - time_start << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
+    }
 
-                cerr << "Warning: Too few unambiguous read pairs available to re-estimate fragment length distribution parameters from alignment paths. Will use parameters given as input instead (mean: " << pre_frag_length_dist.loc() << ", standard deviation: " << pre_frag_length_dist.scale() << ")" << endl;
+    cerr << log_prefix << "Alignment path index contains " << align_paths_index.size() << " unique sets of alignment paths (" << gbwt::inGigabytes(align_paths_index.arenaBytes()) << " GB arena)" << endl;
 
-                frag_length_dist = pre_frag_length_dist;
+    if (option_results.count("write-align-paths")) {
 
-            } else {
+        ofstream align_paths_ostream(option_results["output-prefix"].as<string>() + "_align_paths.bin", ios::binary);
 
-                cerr << "Error: Too few unambiguous read pairs available to re-estimate fragment length distribution parameters from alignment paths. Use --frag-mean and --frag-sd instead." << endl;
-                return 1;
-            }
-        
-        } else {
+        if (!align_paths_ostream.is_open()) {
 
-            cerr << "Fragment length distribution parameters re-estimated from alignment paths (location: " << frag_length_dist.loc() << ", scale: " << frag_length_dist.scale() << ", shape: " << frag_length_dist.shape() << ")" << endl;
+            cerr << log_prefix << "ERROR: Could not write alignment path index file (" << option_results["output-prefix"].as<string>() << "_align_paths.bin)." << endl;
+            return 1;
         }
+
+        align_paths_cache.serialize(align_paths_ostream, align_paths_index, frag_length_dist, unaligned_read_count);
+        align_paths_ostream.close();
     }
 
-    double time_align = gbwt::readTimer();
-    cerr << "Found alignment paths (" << time_align - time_load << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
+    // Each unique search in the alignment paths is located once by all 
+    // threads after indexing, which keeps the indexing threads from 
+    // falling behind the threads finding the alignment paths.
+    PathIdsIndex path_ids_index;
+    path_ids_index.addAlignmentPaths(paths_index, align_paths_index, num_threads);
 
-    PathClusters path_clusters(num_threads, paths_index, align_paths_index);
+    PathClusters path_clusters(num_threads, paths_index, path_ids_index, align_paths_index);
 
     if (option_results.count("path-node-cluster") || collapse_haps) {
 
         path_clusters.addNodeClusters(paths_index);
     }
 
-    vector<vector<vector<align_paths_index_t::iterator> > > align_paths_clusters(path_clusters.cluster_to_paths_index.size(), vector<vector<align_paths_index_t::iterator> >(num_threads));
+    vector<vector<vector<AlignmentPathsIndex::iterator> > > align_paths_clusters(path_clusters.cluster_to_paths_index.size(), vector<vector<AlignmentPathsIndex::iterator> >(num_threads));
+
+    const auto align_paths_index_its = align_paths_index.iterators();
 
+    // Each thread assigns a contiguous range of the alignment paths, which
+    // keeps the alignment paths of each cluster in iteration order.
     #pragma omp parallel num_threads(num_threads)
     {
-        #pragma omp for schedule(static, 1)
-        for (size_t i = 0; i < num_threads; ++i) {
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < align_paths_index_its.size(); ++i) {
 
-            auto align_paths_index_it = align_paths_index.begin();
-            advance(align_paths_index_it, i);
-
-            uint32_t cur_align_paths_idx = i; 
-
-            while (cur_align_paths_idx < align_paths_index.size()) {
-
-                assert(!align_paths_index_it->first.front().gbwt_search.first.empty());
-                const uint32_t anchor_path_id = paths_index.locatePathIds(align_paths_index_it->first.front().gbwt_search).front();
-                
-                align_paths_clusters.at(path_clusters.path_to_cluster_index.at(anchor_path_id)).at(i).emplace_back(align_paths_index_it);
+            assert(!align_paths_index_its.at(i)->first.front().gbwt_search.first.empty());
+            const uint32_t anchor_path_id = path_ids_index.pathIds(align_paths_index_its.at(i)->first.front().gbwt_search).front();
 
-                advance(align_paths_index_it, num_threads);
-                cur_align_paths_idx += num_threads;
-            }
+            align_paths_clusters.at(path_clusters.path_to_cluster_index.at(anchor_path_id)).at(omp_get_thread_num()).emplace_back(align_paths_index_its.at(i));
         }
     }
 
     double time_clust = gbwt::readTimer();
-    cerr << "Clustered alignment paths (" << time_clust - time_align << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
+    cerr << log_prefix << "Clustered alignment paths (" << time_clust - time_align << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
 
-    spp::sparse_hash_map<string, PathInfo> haplotype_transcript_info;
+    const bool parse_haplotype_ids = (inference_model == "haplotype-transcripts");
+    PathInfoParser path_info_parser(num_threads);
 
     if (option_results.count("path-info")) {
 
-        haplotype_transcript_info = parseHaplotypeTranscriptInfo(option_results["path-info"].as<string>(), inference_model == "haplotype-transcripts", collapse_haps);
+        const string path_info_filename = option_results["path-info"].as<string>();
+
+        if (doesFileExist(path_info_filename + ".bin") && path_info_parser.loadBinary(path_info_filename + ".bin", path_info_filename) && (!parse_haplotype_ids || path_info_parser.hasHaplotypeIds())) {
+
+            cerr << log_prefix << "Loaded binary path haplotype/transcript information (" << path_info_filename << ".bin)" << endl;
+
+        } else {
+
+            // Haplotype ids are always parsed when writing the binary table.
+            if (!path_info_parser.parseText(path_info_filename, parse_haplotype_ids || option_results.count("write-path-info-bin"))) {
+
+                cerr << log_prefix << "ERROR: Could not read path haplotype/transcript information file or it contains duplicate path names (--path-info " << path_info_filename << ")." << endl;
+                return 1;
+            }
+
+            if (option_results.count("write-path-info-bin")) {
+
+                path_info_parser.writeBinary(path_info_filename + ".bin", path_info_filename);
+            }
+        }
+
+        double time_info = gbwt::readTimer();
+        cerr << log_prefix << "Parsed path haplotype/transcript information (" << time_info - time_clust << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
     }
 
-    PathEstimator * path_estimator;
+    unique_ptr<PathEstimator> path_estimator;
 
     if (inference_model == "haplotypes") {
 
-        path_estimator = new PathGroupPosteriorEstimator(ploidy, use_hap_gibbs, prob_precision);
+        path_estimator.reset(new PathGroupPosteriorEstimator(ploidy, use_hap_gibbs, prob_precision));
 
     } else if (inference_model == "transcripts") {
 
-        path_estimator = new PathAbundanceEstimator(max_em_its, max_rel_em_conv, num_gibbs_samples, gibbs_thin_its, prob_precision);
+        path_estimator.reset(new PathAbundanceEstimator(max_em_its, max_rel_em_conv, num_gibbs_samples, gibbs_thin_its, prob_precision));
 
     } else if (inference_model == "strains") {
 
-        path_estimator = new MinimumPathAbundanceEstimator(max_em_its, max_rel_em_conv, num_gibbs_samples, gibbs_thin_its, prob_precision);
+        path_estimator.reset(new MinimumPathAbundanceEstimator(max_em_its, max_rel_em_conv, num_gibbs_samples, gibbs_thin_its, prob_precision));
 
     } else if (inference_model == "haplotype-transcripts") {
 
-        path_estimator = new NestedPathAbundanceEstimator(ploidy, min_hap_prob, !ind_hap_inference, use_hap_gibbs, max_em_its, max_rel_em_conv, num_gibbs_samples, gibbs_thin_its, prob_precision);
-        assert(!haplotype_transcript_info.empty());
+        path_estimator.reset(new NestedPathAbundanceEstimator(ploidy, min_hap_prob, !ind_hap_inference, use_hap_gibbs, max_em_its, max_rel_em_conv, num_gibbs_samples, gibbs_thin_its, prob_precision));
+        assert(path_info_parser.numberOfPaths() > 0);
 
     } else {
 
         assert(false);
     }
 
-    ProbabilityClusterWriter * prob_cluster_writer = nullptr;
+    unique_ptr<ProbabilityClusterWriter> prob_cluster_writer;
 
     if (option_results.count("write-probs")) {
 
-        prob_cluster_writer = new ProbabilityClusterWriter(option_results["output-prefix"].as<string>() + "_probs", num_threads, prob_precision);
+        prob_cluster_writer.reset(new ProbabilityClusterWriter(option_results["output-prefix"].as<string>() + "_probs", num_threads, prob_precision));
     }
 
-    ReadCountGibbsSamplesWriter * read_count_samples_writer = nullptr;
+    unique_ptr<ReadCountGibbsSamplesWriter> read_count_samples_writer;
 
     if (num_gibbs_samples > 0 && inference_model != "haplotypes") {
 
-        read_count_samples_writer = new ReadCountGibbsSamplesWriter(option_results["output-prefix"].as<string>() + "_gibbs", num_threads, num_gibbs_samples);
+        read_count_samples_writer.reset(new ReadCountGibbsSamplesWriter(option_results["output-prefix"].as<string>() + "_gibbs", num_threads, num_gibbs_samples));
     }
 
     vector<vector<pair<uint32_t, PathClusterEstimates> > > threaded_path_cluster_estimates(num_threads);
@@ -843,17 +1331,12 @@ int main(int argc, char* argv[]) {
 
             assert(clustered_path_index.emplace(path_id, clustered_path_index.size()).second);
 
-            if (haplotype_transcript_info.empty()) {
-
-                path_cluster_estimates->back().second.paths.emplace_back(PathInfo(paths_index.pathName(path_id)));
-            
-            } else {
+            path_cluster_estimates->back().second.paths.emplace_back(PathInfo(paths_index.pathName(path_id)));
 
-                auto haplotype_transcript_info_it = haplotype_transcript_info.find(paths_index.pathName(path_id));
-                assert(haplotype_transcript_info_it != haplotype_transcript_info.end());
+            if (path_info_parser.numberOfPaths() > 0) {
 
-                path_cluster_estimates->back().second.paths.emplace_back(move(haplotype_transcript_info_it->second));
-            
+                const bool has_path_info = path_info_parser.pathInfo(&(path_cluster_estimates->back().second.paths.back()), paths_index.pathName(path_id), parse_haplotype_ids, collapse_haps);
+                assert(has_path_info);
             } 
 
             path_cluster_estimates->back().second.paths.back().length = paths_index.pathLength(path_id); 
@@ -885,7 +1368,7 @@ int main(int argc, char* argv[]) {
 
                 for (auto & align_path: align_paths->first) {
 
-                    align_paths_ids.emplace_back(paths_index.locatePathIds(align_path.gbwt_search));
+                    align_paths_ids.emplace_back(path_ids_index.pathIds(align_path.gbwt_search));
                 }
 
                 read_path_cluster_probs.emplace_back(ReadPathProbabilities(align_paths->second, prob_precision));
@@ -893,6 +1376,19 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        // All paths of a search are in the same cluster, so the path ids 
+        // of the searches in this cluster are not used again.
+        for (auto & threaded_align_paths: align_paths_clusters.at(align_paths_cluster_idx)) {
+
+            for (auto & align_paths: threaded_align_paths) {
+
+                for (auto & align_path: align_paths->first) {
+
+                    path_ids_index.releasePathIds(align_path.gbwt_search);
+                }
+            }
+        }
+
         if (collapse_haps) {
 
             assert(!group_name_index.empty());
@@ -984,7 +1480,7 @@ int main(int argc, char* argv[]) {
         // }
     }
 
-    delete path_estimator;
+    path_estimator.reset();
 
     if (prob_cluster_writer) {
 
@@ -997,8 +1493,8 @@ int main(int argc, char* argv[]) {
         read_count_samples_writer->close();
     }
 
-    delete prob_cluster_writer;
-    delete read_count_samples_writer;
+    prob_cluster_writer.reset();
+    read_count_samples_writer.reset();
 
     if (inference_model == "haplotypes") {
 
@@ -1075,8 +1571,247 @@ int main(int argc, char* argv[]) {
     }    
 
     double time_end = gbwt::readTimer();
-    cerr << "Inferred path posterior probabilities" << ((inference_model != "haplotypes") ? " and abundances" : "") << " (" << time_end - time_clust << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
+    cerr << log_prefix << "Inferred path posterior probabilities" << ((inference_model != "haplotypes") ? " and abundances" : "") << " (" << time_end - time_clust << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
 
 	return 0;
 }
 
+// Runs a job received by the server. The job arguments are parsed using 
+// the same options as the command line, but the graph and indexes 
+// given to the server are used. Log lines are prefixed with the job id.
+int runJob(const uint64_t job_id, const vector<string> & job_args, const PathsIndex & paths_index) {
+
+    const string log_prefix = "Job " + to_string(job_id) + ": ";
+
+    vector<char *> job_argv;
+    job_argv.reserve(job_args.size() + 1);
+
+    string program_name = "rpvg";
+    job_argv.emplace_back(&program_name.front());
+
+    vector<string> job_args_copy = job_args;
+
+    for (auto & job_arg: job_args_copy) {
+
+        job_argv.emplace_back(&job_arg.front());
+    }
+
+    int job_argc = job_argv.size();
+    char ** job_argv_ptr = job_argv.data();
+
+    auto options = createOptions();
+
+    try {
+
+        auto option_results = options.parse(job_argc, job_argv_ptr);
+
+        if (option_results.count("graph") || option_results.count("paths") || option_results.count("server") || option_results.count("server-jobs") || option_results.count("write-node-lengths") || option_results.count("write-node-clusters") || option_results.count("pair-dist-index")) {
+
+            cerr << log_prefix << "ERROR: Graph and index options (--graph, --paths, --server, --server-jobs, --write-node-lengths, --write-node-clusters and --pair-dist-index) can not be given to a server job." << endl;
+            return 1;
+        }
+
+        if (!checkQuantificationOptions(option_results, log_prefix)) {
+
+            return 1;
+        }
+
+        return runQuantification(option_results, paths_index, log_prefix);
+    
+    } catch (const cxxopts::OptionException & e) {
+
+        cerr << log_prefix << "ERROR: " << e.what() << endl;
+        return 1;
+
+    } catch (const exception & e) {
+
+        // Failures (e.g. malformed input or unwritable output) 
+        // should only stop the job and not the server.
+        cerr << log_prefix << "ERROR: Job failed (" << e.what() << ")." << endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    auto options = createOptions();
+
+    if (argc == 1) {
+
+        cerr << options.help({"Required", "General", "Alignment", "Fragment", "Probability", "Haplotyping", "Quantification"}) << endl;
+        return 1;
+    }
+ 
+    auto option_results = options.parse(argc, argv);
+
+    if (option_results.count("help")) {
+
+        cerr << options.help({"Required", "General", "Alignment", "Fragment", "Probability", "Haplotyping", "Quantification"}) << endl;
+        return 1;
+    }
+
+    if (!option_results.count("graph")) {
+
+        cerr << "ERROR: Graph (xg format) input required (--graph)." << endl;
+        return 1;
+    }
+
+    if (!option_results.count("paths")) {
+
+        cerr << "ERROR: Paths (GBWT index) input required (--paths)." << endl;
+        return 1;
+    }
+
+    const bool is_server = option_results.count("server");
+
+    if (!is_server && !checkQuantificationOptions(option_results, "")) {
+
+        return 1;
+    }
+
+    if (is_server && option_results["server-jobs"].as<uint32_t>() == 0) {
+
+        cerr << "ERROR: Maximum number of server jobs (--server-jobs) can not be 0." << endl;
+        return 1;
+    }
+
+    cerr << "Running rpvg (commit: " << GIT_COMMIT << ")" << endl;
+
+    double time_init = gbwt::readTimer();
+
+    assert(vg::io::register_libvg_io());
+
+    const bool is_node_lengths_file = PathsIndex::isNodeLengthsFile(option_results["graph"].as<string>());
+
+    unique_ptr<handlegraph::HandleGraph> graph;
+
+    if (!is_node_lengths_file) {
+
+        graph = vg::io::VPKG::load_one<handlegraph::HandleGraph>(option_results["graph"].as<string>());
+    }
+
+    unique_ptr<gbwt::GBWT> gbwt_index = vg::io::VPKG::load_one<gbwt::GBWT>(option_results["paths"].as<string>());
+
+    unique_ptr<gbwt::FastLocate> r_index;
+
+    if (doesFileExist(option_results["paths"].as<string>() + ".ri")) {
+
+        r_index = move(vg::io::VPKG::load_one<gbwt::FastLocate>(option_results["paths"].as<string>() + ".ri"));
+        r_index->setGBWT(*gbwt_index);        
+
+    } else {
+
+        r_index = std::make_unique<gbwt::FastLocate>();
+    }
+
+    unique_ptr<PathsIndex> paths_index_ptr;
+
+    if (is_node_lengths_file) {
+
+        ifstream node_lengths_istream(option_results["graph"].as<string>(), ios::binary);
+        assert(node_lengths_istream.is_open());
+
+        paths_index_ptr = std::make_unique<PathsIndex>(*gbwt_index, *r_index, node_lengths_istream);
+        node_lengths_istream.close();
+
+    } else {
+
+        paths_index_ptr = std::make_unique<PathsIndex>(*gbwt_index, *r_index, *graph);
+        graph.reset(nullptr);
+    }
+
+    if (option_results.count("pair-dist-index")) {
+
+        paths_index_ptr->buildPredecessorIndex();
+    }
+
+    // Clusters of paths sharing a node (used by --path-node-cluster and 
+    // transcript collapsing) are stored next to the GBWT index.
+    const string node_clusters_filename = option_results["paths"].as<string>() + ".ncl";
+
+    if (doesFileExist(node_clusters_filename)) {
+
+        ifstream node_clusters_istream(node_clusters_filename, ios::binary);
+        assert(node_clusters_istream.is_open());
+
+        if (!paths_index_ptr->loadNodePathClusters(node_clusters_istream)) {
+
+            cerr << "Warning: Node path clusters (" << node_clusters_filename << ") were not built from the given GBWT index and will not be used." << endl;
+        }
+
+        node_clusters_istream.close();
+    }
+
+    if (option_results.count("write-node-clusters") && !paths_index_ptr->hasNodePathClusters()) {
+
+        paths_index_ptr->buildNodePathClusters(option_results["threads"].as<uint32_t>());
+
+        ofstream node_clusters_ostream(node_clusters_filename, ios::binary);
+        assert(node_clusters_ostream.is_open());
+
+        paths_index_ptr->serializeNodePathClusters(node_clusters_ostream);
+        node_clusters_ostream.close();
+    }
+
+    const PathsIndex & paths_index = *paths_index_ptr;
+
+    if (option_results.count("write-node-lengths")) {
+
+        if (!option_results.count("output-prefix")) {
+
+            cerr << "ERROR: Prefix used for output filenames required (--output-prefix)." << endl;
+            return 1;
+        }
+
+        ofstream node_lengths_ostream(option_results["output-prefix"].as<string>() + "_node_lengths.bin", ios::binary);
+        assert(node_lengths_ostream.is_open());
+
+        paths_index.serializeNodeLengths(node_lengths_ostream);
+        node_lengths_ostream.close();
+    }
+
+    if (paths_index.numberOfPaths() == 0) {
+
+        cerr << "ERROR: The GBWT index does not contain any paths." << endl;
+        return 1;        
+    }
+
+    double time_load = gbwt::readTimer();
+
+    if (r_index->empty()) {
+
+        cerr << "Loaded graph and GBWT (" << time_load - time_init << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;
+
+    } else {
+
+        cerr << "Loaded graph, GBWT and r-index (" << time_load - time_init << " seconds, " << gbwt::inGigabytes(gbwt::memoryUsage()) << " GB)" << endl;        
+    }
+
+    if (is_server) {
+
+        JobServer job_server(option_results["server"].as<string>(), option_results["server-jobs"].as<uint32_t>());
+
+        if (!job_server.isOpen()) {
+
+            cerr << "ERROR: Could not open server socket (--server " << option_results["server"].as<string>() << ")." << endl;
+            return 1;
+        }
+
+        cerr << "Accepting jobs on " << option_results["server"].as<string>() << endl;
+
+        job_server.run([&](const uint64_t job_id, const vector<string> & job_args) { return runJob(job_id, job_args, paths_index); });
+
+        cerr << "Server stopped" << endl;
+        return 0;
+    }
+
+    try {
+
+        return runQuantification(option_results, paths_index, "");
+
+    } catch (const runtime_error & e) {
+
+        cerr << "ERROR: " << e.what() << "." << endl;
+        return 1;
+    }
+}
@@ -1,255 +1,151 @@
 #include <assert.h>
-#include <queue>
 #include <algorithm>
 
 #include "path_clusters.hpp"
 #include "utils.hpp"
 
 
-static const uint32_t paths_per_mutex = 100;
-static const uint32_t clusters_per_mutex = 100;
+PathClusters::PathClusters(const uint32_t num_threads_in, const PathsIndex & paths_index, const PathIdsIndex & path_ids_index, const AlignmentPathsIndex & align_paths_index) : num_threads(num_threads_in), num_paths(paths_index.numberOfPaths()) {
 
-PathClusters::PathClusters(const uint32_t num_threads_in, const PathsIndex & paths_index, const spp::sparse_hash_map<vector<AlignmentPath>, uint32_t> & align_paths_index) : num_threads(num_threads_in), num_paths(paths_index.numberOfPaths()) {
+    ConcurrentUnionFind connected_paths(num_paths);
 
-    vector<spp::sparse_hash_set<uint32_t> > connected_paths(num_paths, spp::sparse_hash_set<uint32_t>());
-    vector<mutex> connected_paths_mutexes(ceil(num_paths / static_cast<double>(paths_per_mutex)));
+    const auto align_paths_index_its = align_paths_index.iterators();
 
-    #pragma omp parallel num_threads(num_threads)
-    {
-        #pragma omp for schedule(static, 1)
-        for (size_t i = 0; i < num_threads; ++i) {
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (size_t i = 0; i < align_paths_index_its.size(); ++i) {
 
-            auto align_paths_index_it = align_paths_index.begin();
-            advance(align_paths_index_it, i);
-
-            uint32_t cur_align_paths_idx = i; 
-
-            while (cur_align_paths_idx < align_paths_index.size()) {
-
-                assert(align_paths_index_it->first.size() > 1);
-                assert(align_paths_index_it->first.back().gbwt_search.first.empty());
-
-                uint32_t anchor_path_id = 0;
-
-                for (size_t j = 0; j < align_paths_index_it->first.size() - 1; ++j) {
-
-                    auto align_path_ids = paths_index.locatePathIds(align_paths_index_it->first.at(j).gbwt_search);
-                    assert(!align_path_ids.empty());
-
-                    if (j == 0) {
-
-                        anchor_path_id = align_path_ids.front();
-                    }
-
-                    auto anchor_path_mutex_idx = floor(anchor_path_id / static_cast<double>(paths_per_mutex));
-
-                    for (auto & path_id: align_path_ids) {
-
-                        if (anchor_path_id != path_id) {
+        uniteAlignmentPaths(&connected_paths, path_ids_index, align_paths_index_its.at(i)->first);
+    }
 
-                            auto path_mutex_idx = floor(path_id / static_cast<double>(paths_per_mutex));
+    createPathClusters(connected_paths);
+}
 
-                            if (path_mutex_idx != anchor_path_mutex_idx) {
+void PathClusters::uniteAlignmentPaths(ConcurrentUnionFind * connected_paths, const PathIdsIndex & path_ids_index, const AlignmentPathSpan & align_paths) {
 
-                                lock(connected_paths_mutexes.at(anchor_path_mutex_idx), connected_paths_mutexes.at(path_mutex_idx));
+    assert(align_paths.size() > 1);
+    assert(align_paths.back().gbwt_search.first.empty());
 
-                            } else {
+    uint32_t anchor_path_id = 0;
 
-                                connected_paths_mutexes.at(anchor_path_mutex_idx).lock();
-                            }
-                                                    
-                            if (connected_paths.at(anchor_path_id).emplace(path_id).second) {
+    for (size_t i = 0; i < align_paths.size() - 1; ++i) {
 
-                                connected_paths.at(path_id).emplace(anchor_path_id);
-                            }
+        auto & align_path_ids = path_ids_index.pathIds(align_paths.at(i).gbwt_search);
+        assert(!align_path_ids.empty());
 
-                            connected_paths_mutexes.at(anchor_path_mutex_idx).unlock();
+        if (i == 0) {
 
-                            if (path_mutex_idx != anchor_path_mutex_idx) {
+            anchor_path_id = align_path_ids.front();
+        }
 
-                                connected_paths_mutexes.at(path_mutex_idx).unlock();
-                            }
-                        }
-                    }
-                }
+        for (auto & path_id: align_path_ids) {
 
-                advance(align_paths_index_it, num_threads);
-                cur_align_paths_idx += num_threads;
-            }
+            connected_paths->unite(anchor_path_id, path_id);
         }
     }
-
-    createPathClusters(connected_paths);
 }
 
 void PathClusters::addNodeClusters(const PathsIndex & paths_index) {
 
-    vector<spp::sparse_hash_set<uint32_t> > connected_clusters(cluster_to_paths_index.size(), spp::sparse_hash_set<uint32_t>());
-    vector<mutex> connected_clusters_mutexes(ceil(cluster_to_paths_index.size() / static_cast<double>(clusters_per_mutex)));
-
-    #pragma omp parallel num_threads(num_threads)
-    {
-        #pragma omp for schedule(static)
-        for (size_t i = 1; i <= paths_index.numberOfNodes(); ++i) {
-
-            vector<vector<gbwt::size_type> > node_path_id_sets;
-
-            pair<gbwt::SearchState, gbwt::size_type> gbwt_search;
-            paths_index.find(&gbwt_search, gbwt::Node::encode(i, false));
-
-            if (!gbwt_search.first.empty()) {
-
-                node_path_id_sets.emplace_back(paths_index.locatePathIds(gbwt_search));
-            }
-
-            if (!paths_index.bidirectional()) {
-
-                paths_index.find(&gbwt_search, gbwt::Node::encode(i, true));
-
-                if (!gbwt_search.first.empty()) {
-
-                    node_path_id_sets.emplace_back(paths_index.locatePathIds(gbwt_search));
-                }
-            }
+    assert(paths_index.numberOfPaths() == num_paths);
 
-            for (auto & node_path_ids: node_path_id_sets) {
+    ConcurrentUnionFind connected_clusters(cluster_to_paths_index.size());
 
-                if (!node_path_ids.empty()) {
+    // First path in each cluster of paths sharing a node.
+    vector<uint32_t> node_cluster_anchor_paths(num_paths, -1);
 
-                    auto anchor_cluster_id = path_to_cluster_index.at(node_path_ids.front());
-                    auto anchor_cluster_mutex_idx = floor(anchor_cluster_id / static_cast<double>(clusters_per_mutex));
+    auto add_node_cluster_path = [&](const uint32_t node_cluster_id, const uint32_t path_id) {
 
-                    for (auto & path_id: node_path_ids) {
+        if (node_cluster_anchor_paths.at(node_cluster_id) == -1) {
 
-                        auto cluster_id = path_to_cluster_index.at(path_id);
+            node_cluster_anchor_paths.at(node_cluster_id) = path_id;
 
-                        if (anchor_cluster_id != cluster_id) {
+        } else {
 
-                            auto cluster_mutex_idx = floor(cluster_id / static_cast<double>(clusters_per_mutex));
-
-                            if (cluster_mutex_idx != anchor_cluster_mutex_idx) {
+            connected_clusters.unite(path_to_cluster_index.at(node_cluster_anchor_paths.at(node_cluster_id)), path_to_cluster_index.at(path_id));
+        }
+    };
 
-                                lock(connected_clusters_mutexes.at(anchor_cluster_mutex_idx), connected_clusters_mutexes.at(cluster_mutex_idx));
+    if (paths_index.hasNodePathClusters()) {
 
-                            } else {
+        for (uint32_t i = 0; i < num_paths; ++i) {
 
-                                connected_clusters_mutexes.at(anchor_cluster_mutex_idx).lock();
-                            }
-                                                    
-                            if (connected_clusters.at(anchor_cluster_id).emplace(cluster_id).second) {
+            add_node_cluster_path(paths_index.nodePathCluster(i), i);
+        }
 
-                                connected_clusters.at(cluster_id).emplace(anchor_cluster_id);
-                            }
+    } else {
 
-                            connected_clusters_mutexes.at(anchor_cluster_mutex_idx).unlock();
+        ConcurrentUnionFind node_connected_paths(num_paths);
+        paths_index.uniteNodePaths(&node_connected_paths, num_threads);
 
-                            if (cluster_mutex_idx != anchor_cluster_mutex_idx) {
+        for (uint32_t i = 0; i < num_paths; ++i) {
 
-                                connected_clusters_mutexes.at(cluster_mutex_idx).unlock();
-                            }
-                        }
-                    }
-                }
-            }
+            add_node_cluster_path(node_connected_paths.find(i), i);
         }
     }
 
-    if (!connected_clusters.empty()) {
+    if (connected_clusters.size() > 0) {
 
         mergeClusters(connected_clusters);
     }
 }
 
-void PathClusters::createPathClusters(const vector<spp::sparse_hash_set<uint32_t> > & connected_paths) {
+void PathClusters::createPathClusters(const ConcurrentUnionFind & connected_paths) {
 
     assert(path_to_cluster_index.empty());
     assert(cluster_to_paths_index.empty());
 
+    assert(connected_paths.size() == num_paths);
+
+    // Clusters are numbered by their smallest path id, which makes the
+    // numbering independent of the order the paths were united in.
+    vector<uint32_t> root_to_cluster_index(num_paths, -1);
     path_to_cluster_index = vector<uint32_t>(num_paths, -1);
 
     for (uint32_t i = 0; i < num_paths; ++i) {
 
-        if (path_to_cluster_index.at(i) == -1) {
+        auto root_path = connected_paths.find(i);
 
-            queue<uint32_t> search_queue;
-            search_queue.push(i);
+        if (root_to_cluster_index.at(root_path) == -1) {
 
+            root_to_cluster_index.at(root_path) = cluster_to_paths_index.size();
             cluster_to_paths_index.emplace_back(vector<uint32_t>());
-
-            while (!search_queue.empty()) {
-
-                auto cur_path = search_queue.front();
-
-                bool is_first_visit = (path_to_cluster_index.at(cur_path) == -1);
-                assert(is_first_visit || path_to_cluster_index.at(cur_path) == cluster_to_paths_index.size() - 1);
-
-                path_to_cluster_index.at(cur_path) = cluster_to_paths_index.size() - 1;
-                
-                if (is_first_visit) {
-
-                    cluster_to_paths_index.back().emplace_back(cur_path);
-
-                    for (auto & next_path: connected_paths.at(cur_path)) {
-
-                        if (path_to_cluster_index.at(next_path) == -1) {
-
-                            search_queue.push(next_path);
-                        }
-                    }
-                }
-
-                search_queue.pop();
-            }
-
-            sort(cluster_to_paths_index.back().begin(), cluster_to_paths_index.back().end());
         }
+
+        path_to_cluster_index.at(i) = root_to_cluster_index.at(root_path);
+        cluster_to_paths_index.at(path_to_cluster_index.at(i)).emplace_back(i);
     }
 }
 
-void PathClusters::mergeClusters(const vector<spp::sparse_hash_set<uint32_t> > & connected_clusters) {
+void PathClusters::mergeClusters(const ConcurrentUnionFind & connected_clusters) {
+
+    assert(connected_clusters.size() == cluster_to_paths_index.size());
 
     auto old_cluster_to_paths_index = cluster_to_paths_index;
     cluster_to_paths_index.clear();
 
-    vector<bool> visited_old_clusters(old_cluster_to_paths_index.size(), false);
+    vector<uint32_t> root_to_cluster_index(old_cluster_to_paths_index.size(), -1);
 
     for (uint32_t i = 0; i < old_cluster_to_paths_index.size(); ++i) {
 
-        if (!visited_old_clusters.at(i)) {
+        auto root_cluster = connected_clusters.find(i);
 
-            queue<uint32_t> search_queue;
-            search_queue.push(i);
+        if (root_to_cluster_index.at(root_cluster) == -1) {
 
+            root_to_cluster_index.at(root_cluster) = cluster_to_paths_index.size();
             cluster_to_paths_index.emplace_back(vector<uint32_t>());
+        }
 
-            while (!search_queue.empty()) {
-
-                auto cur_cluster = search_queue.front();
-                
-                if (!visited_old_clusters.at(cur_cluster)) {
-
-                    visited_old_clusters.at(cur_cluster) = true;
-                    cluster_to_paths_index.back().insert(cluster_to_paths_index.back().end(), old_cluster_to_paths_index.at(cur_cluster).begin(), old_cluster_to_paths_index.at(cur_cluster).end());
-
-                    for (auto & next_cluster: connected_clusters.at(cur_cluster)) {
-
-                        if (!visited_old_clusters.at(next_cluster)) {
-
-                            search_queue.push(next_cluster);
-                        }
-                    }
-                }
+        auto & cluster_paths = cluster_to_paths_index.at(root_to_cluster_index.at(root_cluster));
+        cluster_paths.insert(cluster_paths.end(), old_cluster_to_paths_index.at(i).begin(), old_cluster_to_paths_index.at(i).end());
+    }
 
-                search_queue.pop();
-            }
+    for (uint32_t i = 0; i < cluster_to_paths_index.size(); ++i) {
 
-            sort(cluster_to_paths_index.back().begin(), cluster_to_paths_index.back().end());
+        sort(cluster_to_paths_index.at(i).begin(), cluster_to_paths_index.at(i).end());
 
-            for (auto & path: cluster_to_paths_index.back()) {
+        for (auto & path: cluster_to_paths_index.at(i)) {
 
-                path_to_cluster_index.at(path) = cluster_to_paths_index.size() - 1;
-            } 
-        }
+            path_to_cluster_index.at(path) = i;
+        } 
     } 
 }
-
@@ -8,6 +8,9 @@
 
 #include "paths_index.hpp"
 #include "alignment_path.hpp"
+#include "alignment_paths_index.hpp"
+#include "path_ids_index.hpp"
+#include "concurrent_union_find.hpp"
 
 using namespace std;
 
@@ -16,8 +19,7 @@ class PathClusters {
 
     public: 
 
-        PathClusters(const uint32_t num_threads_in, const PathsIndex & paths_index, const spp::sparse_hash_map<vector<AlignmentPath>, uint32_t> & align_paths_index);
-
+        PathClusters(const uint32_t num_threads_in, const PathsIndex & paths_index, const PathIdsIndex & path_ids_index, const AlignmentPathsIndex & align_paths_index);
         void addNodeClusters(const PathsIndex & paths_index);
 
         vector<uint32_t> path_to_cluster_index;
@@ -28,8 +30,12 @@ class PathClusters {
         const uint32_t num_threads;
         const uint32_t num_paths;
 
-    	void createPathClusters(const vector<spp::sparse_hash_set<uint32_t> > & connected_paths);
-        void mergeClusters(const vector<spp::sparse_hash_set<uint32_t> > & connected_clusters);
+        // Unites the paths of a set of alignment paths. Different sets 
+        // can be united in parallel.
+        static void uniteAlignmentPaths(ConcurrentUnionFind * connected_paths, const PathIdsIndex & path_ids_index, const AlignmentPathSpan & align_paths);
+
+    	void createPathClusters(const ConcurrentUnionFind & connected_paths);
+        void mergeClusters(const ConcurrentUnionFind & connected_clusters);
 };
 
 
@@ -0,0 +1,69 @@
+
+#include "path_ids_index.hpp"
+
+#include <assert.h>
+#include <algorithm>
+
+
+PathIdsIndex::PathIdsIndex() {}
+
+size_t PathIdsIndex::size() const {
+
+    return index.size();
+}
+
+void PathIdsIndex::addAlignmentPaths(const PathsIndex & paths_index, const AlignmentPathsIndex & align_paths_index, const uint32_t num_threads) {
+
+    vector<pair<gbwt::SearchState, gbwt::size_type> > new_gbwt_searches;
+
+    for (auto & align_paths: align_paths_index) {
+
+        for (auto & align_path: align_paths.first) {
+
+            if (index.emplace(align_path.gbwt_search, vector<gbwt::size_type>()).second) {
+
+                new_gbwt_searches.emplace_back(align_path.gbwt_search);
+            }
+        }
+    }
+
+    // The index is not modified while the searches are located and each 
+    // thread therefore only writes to the path ids of its own searches.
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+    for (size_t i = 0; i < new_gbwt_searches.size(); ++i) {
+
+        auto index_it = index.find(new_gbwt_searches.at(i));
+        assert(index_it != index.end());
+
+        index_it->second = locatePathIds(paths_index, new_gbwt_searches.at(i));
+    }
+}
+
+const vector<gbwt::size_type> & PathIdsIndex::pathIds(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const {
+
+    auto index_it = index.find(gbwt_search);
+    assert(index_it != index.end());
+
+    return index_it->second;
+}
+
+void PathIdsIndex::releasePathIds(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) {
+
+    auto index_it = index.find(gbwt_search);
+    assert(index_it != index.end());
+
+    vector<gbwt::size_type>().swap(index_it->second);
+}
+
+vector<gbwt::size_type> PathIdsIndex::locatePathIds(const PathsIndex & paths_index, const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const {
+
+    if (gbwt_search.first.empty()) {
+
+        return vector<gbwt::size_type>();
+    }
+
+    auto path_ids = paths_index.locatePathIds(gbwt_search);
+    sort(path_ids.begin(), path_ids.end());
+
+    return path_ids;
+}
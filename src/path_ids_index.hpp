@@ -0,0 +1,72 @@
+
+#ifndef RPVG_SRC_PATHIDSINDEX_HPP
+#define RPVG_SRC_PATHIDSINDEX_HPP
+
+#include <vector>
+
+#include "gbwt/gbwt.h"
+#include "sparsepp/spp.h"
+
+#include "paths_index.hpp"
+#include "alignment_path.hpp"
+#include "alignment_paths_index.hpp"
+
+using namespace std;
+
+
+struct GBWTSearchHash {
+
+    size_t operator()(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const {
+
+        size_t seed = 0;
+
+        spp::hash_combine(seed, gbwt_search.first.node);
+        spp::hash_combine(seed, gbwt_search.first.range.first);
+        spp::hash_combine(seed, gbwt_search.first.range.second);
+        spp::hash_combine(seed, gbwt_search.second);
+
+        return seed;
+    }
+};
+
+// Index of the sorted path ids of unique GBWT (or r-index) searches. The 
+// path ids are shared by the clustering and probability calculation of the
+// alignment paths. Each search is located once after all alignment paths 
+// have been indexed. Path ids are kept until they are released, so the peak 
+// memory use is proportional to the summed number of path ids of all unique 
+// searches.
+class PathIdsIndex {
+
+    public:
+
+        typedef spp::sparse_hash_map<pair<gbwt::SearchState, gbwt::size_type>, vector<gbwt::size_type>, GBWTSearchHash> index_t;
+
+        PathIdsIndex();
+
+        PathIdsIndex(const PathIdsIndex &) = delete;
+        PathIdsIndex & operator=(const PathIdsIndex &) = delete;
+
+        PathIdsIndex(PathIdsIndex &&) = default;
+        PathIdsIndex & operator=(PathIdsIndex &&) = default;
+
+        size_t size() const;
+
+        // Locates the searches of the alignment paths that are 
+        // not already in the index using multiple threads.
+        void addAlignmentPaths(const PathsIndex & paths_index, const AlignmentPathsIndex & align_paths_index, const uint32_t num_threads);
+
+        const vector<gbwt::size_type> & pathIds(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const;
+
+        // Frees the path ids of the search, which are empty afterwards. 
+        // Different searches can be released in parallel.
+        void releasePathIds(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search);
+
+    private:
+
+        index_t index;
+
+        vector<gbwt::size_type> locatePathIds(const PathsIndex & paths_index, const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const;
+};
+
+
+#endif
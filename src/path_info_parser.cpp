@@ -0,0 +1,648 @@
+
+#include "path_info_parser.hpp"
+
+#include <assert.h>
+#include <string.h>
+#include <fstream>
+#include <algorithm>
+#include <sys/stat.h>
+#include <omp.h>
+
+#include "sparsepp/spp.h"
+#include "htslib/bgzf.h"
+#include "htslib/hts.h"
+
+
+// Increase when the binary layout of the table changes.
+static const uint64_t path_info_binary_magic = 0x5250564750494e46;
+static const uint32_t path_info_binary_version = 2;
+
+static const uint32_t path_info_binary_header_size = 7;
+
+static const uint32_t path_info_read_size = 4194304;
+
+// Reference to a string in the parsed text.
+struct StringRef {
+
+    const char * data;
+    uint32_t length;
+
+    StringRef() : data(nullptr), length(0) {}
+    StringRef(const char * data_in, const uint32_t length_in) : data(data_in), length(length_in) {}
+};
+
+struct StringRefHash {
+
+    size_t operator()(const StringRef & str) const {
+
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (uint32_t i = 0; i < str.length; ++i) {
+
+            hash ^= static_cast<unsigned char>(str.data[i]);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+};
+
+struct StringRefEqual {
+
+    bool operator()(const StringRef & lhs, const StringRef & rhs) const {
+
+        return (lhs.length == rhs.length && memcmp(lhs.data, rhs.data, lhs.length) == 0);
+    }
+};
+
+typedef spp::sparse_hash_map<StringRef, uint32_t, StringRefHash, StringRefEqual> string_ref_index_t;
+
+// Paths parsed from a block of lines. Transcript and haplotype ids are
+// local to the block and numbered in order of first occurrence.
+struct PathInfoBlock {
+
+    vector<uint64_t> name_offsets;
+    vector<uint32_t> name_lengths;
+
+    vector<uint64_t> transcript_offsets;
+    vector<uint32_t> transcript_lengths;
+
+    vector<uint32_t> transcript_ids;
+    vector<uint32_t> haplotype_counts;
+
+    vector<uint32_t> haplotype_id_counts;
+    vector<uint32_t> haplotype_ids;
+
+    vector<StringRef> transcripts;
+    vector<StringRef> haplotypes;
+};
+
+static uint64_t fileSize(const string & filename) {
+
+    struct stat file_stat;
+
+    if (stat(filename.c_str(), &file_stat) != 0) {
+
+        return 0;
+    }
+
+    return file_stat.st_size;
+}
+
+static uint64_t fileModificationTime(const string & filename) {
+
+    struct stat file_stat;
+
+    if (stat(filename.c_str(), &file_stat) != 0) {
+
+        return 0;
+    }
+
+    return static_cast<uint64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + file_stat.st_mtim.tv_nsec;
+}
+
+static int compareNames(const char * name_1, const uint32_t length_1, const char * name_2, const uint32_t length_2) {
+
+    const int compare = memcmp(name_1, name_2, min(length_1, length_2));
+
+    if (compare != 0) {
+
+        return compare;
+    }
+
+    return (length_1 < length_2) ? -1 : (length_1 > length_2);
+}
+
+static const char * nextDelimiter(const char * begin, const char * end, const char delim) {
+
+    auto delim_pos = static_cast<const char *>(memchr(begin, delim, end - begin));
+    return (delim_pos ? delim_pos : end);
+}
+
+static void parsePathInfoBlock(const char * text, const uint64_t block_start, const uint64_t block_end, const bool is_old_format, const bool parse_haplotype_ids, PathInfoBlock * block) {
+
+    string_ref_index_t transcript_index;
+    string_ref_index_t haplotype_index;
+
+    const char * line_start = text + block_start;
+    const char * block_end_ptr = text + block_end;
+
+    while (line_start < block_end_ptr) {
+
+        const char * line_end = nextDelimiter(line_start, block_end_ptr, '\n');
+
+        if (line_end == line_start) {
+
+            line_start = line_end + 1;
+            continue;
+        }
+
+        const char * name_end = nextDelimiter(line_start, line_end, '\t');
+        assert(name_end < line_end);
+
+        const char * length_end = nextDelimiter(name_end + 1, line_end, '\t');
+        assert(length_end < line_end);
+
+        const char * transcript_start = length_end + 1;
+        const char * transcript_end = nextDelimiter(transcript_start, line_end, '\t');
+
+        const char * haplotypes_start = min(transcript_end + 1, line_end);
+
+        if (is_old_format) {
+
+            haplotypes_start = min(nextDelimiter(haplotypes_start, line_end, '\t') + 1, line_end);
+        }
+
+        block->name_offsets.emplace_back(line_start - text);
+        block->name_lengths.emplace_back(name_end - line_start);
+
+        block->transcript_offsets.emplace_back(transcript_start - text);
+        block->transcript_lengths.emplace_back(transcript_end - transcript_start);
+
+        auto transcript_index_it = transcript_index.emplace(StringRef(transcript_start, transcript_end - transcript_start), transcript_index.size());
+
+        if (transcript_index_it.second) {
+
+            block->transcripts.emplace_back(transcript_index_it.first->first);
+        }
+
+        block->transcript_ids.emplace_back(transcript_index_it.first->second);
+
+        block->haplotype_counts.emplace_back(count(haplotypes_start, line_end, ',') + 1);
+
+        if (parse_haplotype_ids) {
+
+            uint32_t haplotype_id_count = 0;
+            const char * haplotype_start = haplotypes_start;
+
+            // A trailing empty haplotype name is counted above
+            // but is not given an id.
+            while (haplotype_start < line_end) {
+
+                const char * haplotype_end = nextDelimiter(haplotype_start, line_end, ',');
+                auto haplotype_index_it = haplotype_index.emplace(StringRef(haplotype_start, haplotype_end - haplotype_start), haplotype_index.size());
+
+                if (haplotype_index_it.second) {
+
+                    block->haplotypes.emplace_back(haplotype_index_it.first->first);
+                }
+
+                block->haplotype_ids.emplace_back(haplotype_index_it.first->second);
+                ++haplotype_id_count;
+
+                haplotype_start = haplotype_end + 1;
+            }
+
+            block->haplotype_id_counts.emplace_back(haplotype_id_count);
+        }
+
+        line_start = line_end + 1;
+    }
+}
+
+template<typename T>
+static void mapArray(const T ** values, const char ** binary_pos, const uint64_t num_values) {
+
+    *values = reinterpret_cast<const T *>(*binary_pos);
+    *binary_pos += num_values * sizeof(T);
+}
+
+PathInfoParser::PathInfoParser(const uint32_t num_threads_in) : num_threads(num_threads_in), has_haplotype_ids(false) {
+
+    assert(num_threads > 0);
+    setParsedTable();
+}
+
+void PathInfoParser::setParsedTable() {
+
+    table.num_paths = name_offsets.size();
+    table.num_haplotype_ids = haplotype_ids.size();
+    table.string_pool_size = string_pool.size();
+
+    table.string_pool = string_pool.data();
+
+    table.name_offsets = name_offsets.data();
+    table.name_lengths = name_lengths.data();
+
+    table.transcript_offsets = transcript_offsets.data();
+    table.transcript_lengths = transcript_lengths.data();
+
+    table.transcript_ids = transcript_ids.data();
+    table.haplotype_counts = haplotype_counts.data();
+
+    table.haplotype_id_offsets = haplotype_id_offsets.data();
+    table.haplotype_ids = haplotype_ids.data();
+
+    table.sorted_path_indices = sorted_path_indices.data();
+}
+
+void PathInfoParser::clear() {
+
+    has_haplotype_ids = false;
+
+    string_pool.clear();
+
+    name_offsets.clear();
+    name_lengths.clear();
+
+    transcript_offsets.clear();
+    transcript_lengths.clear();
+
+    transcript_ids.clear();
+    haplotype_counts.clear();
+
+    haplotype_id_offsets.clear();
+    haplotype_ids.clear();
+
+    sorted_path_indices.clear();
+
+    binary_mmap.unmap();
+    setParsedTable();
+}
+
+bool PathInfoParser::parseText(const string & filename, const bool parse_haplotype_ids) {
+
+    auto info_file = bgzf_open(filename.c_str(), "r");
+
+    if (!info_file) {
+
+        return false;
+    }
+
+    if (num_threads > 1) {
+
+        bgzf_mt(info_file, num_threads, 256);
+    }
+
+    vector<char> text;
+    uint64_t text_size = 0;
+
+    while (true) {
+
+        text.resize(text_size + path_info_read_size);
+        const ssize_t read_size = bgzf_read(info_file, text.data() + text_size, path_info_read_size);
+
+        assert(read_size >= 0);
+        text_size += read_size;
+
+        if (read_size == 0) {
+
+            break;
+        }
+    }
+
+    assert(bgzf_close(info_file) == 0);
+
+    text.resize(text_size);
+    text.shrink_to_fit();
+
+    const char * header_end = nextDelimiter(text.data(), text.data() + text.size(), '\n');
+    const string header(static_cast<const char *>(text.data()), header_end);
+
+    assert(header.substr(0, 5) == "Name\t");
+    const bool is_old_format = (header.find("Reference") != string::npos);
+
+    // Split text into blocks of lines that are parsed in parallel.
+    const uint64_t text_start = min(static_cast<uint64_t>(header_end - text.data()) + 1, text_size);
+
+    vector<uint64_t> block_starts(num_threads + 1, text_size);
+    block_starts.front() = text_start;
+
+    for (uint32_t i = 1; i < num_threads; ++i) {
+
+        uint64_t block_start = max(block_starts.at(i - 1), text_start + (text_size - text_start) * i / num_threads);
+
+        if (block_start > text_start && block_start < text_size && text.at(block_start - 1) != '\n') {
+
+            block_start = nextDelimiter(text.data() + block_start, text.data() + text_size, '\n') - text.data();
+            block_start = min(block_start + 1, text_size);
+        }
+
+        block_starts.at(i) = block_start;
+    }
+
+    vector<PathInfoBlock> blocks(num_threads);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        #pragma omp for schedule(static, 1)
+        for (size_t i = 0; i < num_threads; ++i) {
+
+            parsePathInfoBlock(text.data(), block_starts.at(i), block_starts.at(i + 1), is_old_format, parse_haplotype_ids, &(blocks.at(i)));
+        }
+    }
+
+    // Map block ids to global ids in block order, which gives
+    // the same ids as parsing the text sequentially.
+    string_ref_index_t transcript_index;
+    string_ref_index_t haplotype_index;
+
+    vector<vector<uint32_t> > block_transcript_ids(num_threads);
+    vector<vector<uint32_t> > block_haplotype_ids(num_threads);
+
+    vector<uint64_t> block_path_offsets(num_threads + 1, 0);
+    vector<uint64_t> block_haplotype_offsets(num_threads + 1, 0);
+
+    for (size_t i = 0; i < num_threads; ++i) {
+
+        block_transcript_ids.at(i).reserve(blocks.at(i).transcripts.size());
+
+        for (auto & transcript: blocks.at(i).transcripts) {
+
+            block_transcript_ids.at(i).emplace_back(transcript_index.emplace(transcript, transcript_index.size()).first->second);
+        }
+
+        block_haplotype_ids.at(i).reserve(blocks.at(i).haplotypes.size());
+
+        for (auto & haplotype: blocks.at(i).haplotypes) {
+
+            block_haplotype_ids.at(i).emplace_back(haplotype_index.emplace(haplotype, haplotype_index.size()).first->second);
+        }
+
+        block_path_offsets.at(i + 1) = block_path_offsets.at(i) + blocks.at(i).name_offsets.size();
+        block_haplotype_offsets.at(i + 1) = block_haplotype_offsets.at(i) + blocks.at(i).haplotype_ids.size();
+    }
+
+    const uint64_t num_paths = block_path_offsets.back();
+
+    has_haplotype_ids = parse_haplotype_ids;
+
+    name_offsets = vector<uint64_t>(num_paths);
+    name_lengths = vector<uint32_t>(num_paths);
+
+    transcript_offsets = vector<uint64_t>(num_paths);
+    transcript_lengths = vector<uint32_t>(num_paths);
+
+    transcript_ids = vector<uint32_t>(num_paths);
+    haplotype_counts = vector<uint32_t>(num_paths);
+
+    haplotype_id_offsets = vector<uint64_t>(has_haplotype_ids ? num_paths + 1 : 0, 0);
+    haplotype_ids = vector<uint32_t>(block_haplotype_offsets.back());
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        #pragma omp for schedule(static, 1)
+        for (size_t i = 0; i < num_threads; ++i) {
+
+            const PathInfoBlock & block = blocks.at(i);
+
+            const uint64_t path_offset = block_path_offsets.at(i);
+            uint64_t haplotype_offset = block_haplotype_offsets.at(i);
+
+            for (size_t j = 0; j < block.name_offsets.size(); ++j) {
+
+                name_offsets.at(path_offset + j) = block.name_offsets.at(j);
+                name_lengths.at(path_offset + j) = block.name_lengths.at(j);
+
+                transcript_offsets.at(path_offset + j) = block.transcript_offsets.at(j);
+                transcript_lengths.at(path_offset + j) = block.transcript_lengths.at(j);
+
+                transcript_ids.at(path_offset + j) = block_transcript_ids.at(i).at(block.transcript_ids.at(j));
+                haplotype_counts.at(path_offset + j) = block.haplotype_counts.at(j);
+
+                if (has_haplotype_ids) {
+
+                    haplotype_id_offsets.at(path_offset + j) = haplotype_offset;
+
+                    for (uint32_t k = 0; k < block.haplotype_id_counts.at(j); ++k) {
+
+                        haplotype_ids.at(haplotype_offset) = block_haplotype_ids.at(i).at(block.haplotype_ids.at(haplotype_offset - block_haplotype_offsets.at(i)));
+                        ++haplotype_offset;
+                    }
+                }
+            }
+        }
+    }
+
+    if (has_haplotype_ids) {
+
+        haplotype_id_offsets.back() = haplotype_ids.size();
+    }
+
+    string_pool = move(text);
+
+    sorted_path_indices = vector<uint32_t>(num_paths);
+
+    for (uint32_t i = 0; i < num_paths; ++i) {
+
+        sorted_path_indices.at(i) = i;
+    }
+
+    sort(sorted_path_indices.begin(), sorted_path_indices.end(), [&](const uint32_t lhs, const uint32_t rhs) {
+
+        return (compareNames(string_pool.data() + name_offsets.at(lhs), name_lengths.at(lhs), string_pool.data() + name_offsets.at(rhs), name_lengths.at(rhs)) < 0);
+    });
+
+    binary_mmap.unmap();
+
+    for (uint32_t i = 1; i < num_paths; ++i) {
+
+        const uint32_t prev_path_idx = sorted_path_indices.at(i - 1);
+        const uint32_t path_idx = sorted_path_indices.at(i);
+
+        if (compareNames(string_pool.data() + name_offsets.at(prev_path_idx), name_lengths.at(prev_path_idx), string_pool.data() + name_offsets.at(path_idx), name_lengths.at(path_idx)) == 0) {
+
+            clear();
+            return false;
+        }
+    }
+
+    setParsedTable();
+
+    return true;
+}
+
+bool PathInfoParser::loadBinary(const string & filename, const string & text_filename) {
+
+    error_code mmap_error;
+
+    mio::mmap_source new_binary_mmap;
+    new_binary_mmap.map(filename, mmap_error);
+
+    if (mmap_error) {
+
+        return false;
+    }
+
+    const uint64_t header_size = path_info_binary_header_size * sizeof(uint64_t);
+
+    if (new_binary_mmap.size() < header_size) {
+
+        return false;
+    }
+
+    const char * binary_data = new_binary_mmap.data();
+
+    uint64_t header[path_info_binary_header_size];
+    memcpy(header, binary_data, header_size);
+
+    if (header[0] != path_info_binary_magic || static_cast<uint32_t>(header[1]) != path_info_binary_version || header[2] != fileSize(text_filename) || header[3] != fileModificationTime(text_filename)) {
+
+        return false;
+    }
+
+    Table new_table;
+
+    new_table.num_paths = header[4];
+    new_table.num_haplotype_ids = header[5];
+    new_table.string_pool_size = header[6];
+
+    const bool new_has_haplotype_ids = (header[1] >> 32);
+    const uint64_t num_haplotype_id_offsets = new_has_haplotype_ids ? new_table.num_paths + 1 : 0;
+
+    const uint64_t binary_size = header_size + (2 * new_table.num_paths + num_haplotype_id_offsets) * sizeof(uint64_t) + (5 * new_table.num_paths + new_table.num_haplotype_ids) * sizeof(uint32_t) + new_table.string_pool_size;
+
+    if (new_binary_mmap.size() != binary_size) {
+
+        return false;
+    }
+
+    // The table is used in place. The 64-bit arrays are written 
+    // first so that all arrays are aligned in the mapping.
+    const char * binary_pos = binary_data + header_size;
+
+    mapArray(&new_table.name_offsets, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.transcript_offsets, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.haplotype_id_offsets, &binary_pos, num_haplotype_id_offsets);
+
+    mapArray(&new_table.name_lengths, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.transcript_lengths, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.transcript_ids, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.haplotype_counts, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.sorted_path_indices, &binary_pos, new_table.num_paths);
+    mapArray(&new_table.haplotype_ids, &binary_pos, new_table.num_haplotype_ids);
+
+    mapArray(&new_table.string_pool, &binary_pos, new_table.string_pool_size);
+    assert(binary_pos == binary_data + binary_size);
+
+    clear();
+
+    has_haplotype_ids = new_has_haplotype_ids;
+
+    table = new_table;
+    binary_mmap = move(new_binary_mmap);
+
+    return true;
+}
+
+void PathInfoParser::writeBinary(const string & filename, const string & text_filename) const {
+
+    const uint64_t num_paths = table.num_paths;
+
+    // Compact string pool containing path names
+    // followed by the unique transcript names.
+    vector<char> compact_string_pool;
+
+    vector<uint64_t> compact_name_offsets;
+    compact_name_offsets.reserve(num_paths);
+
+    for (size_t i = 0; i < num_paths; ++i) {
+
+        compact_name_offsets.emplace_back(compact_string_pool.size());
+        compact_string_pool.insert(compact_string_pool.end(), table.string_pool + table.name_offsets[i], table.string_pool + table.name_offsets[i] + table.name_lengths[i]);
+    }
+
+    vector<uint64_t> compact_transcript_offsets(num_paths, 0);
+    vector<uint64_t> transcript_id_offsets;
+
+    for (size_t i = 0; i < num_paths; ++i) {
+
+        if (table.transcript_ids[i] == transcript_id_offsets.size()) {
+
+            transcript_id_offsets.emplace_back(compact_string_pool.size());
+            compact_string_pool.insert(compact_string_pool.end(), table.string_pool + table.transcript_offsets[i], table.string_pool + table.transcript_offsets[i] + table.transcript_lengths[i]);
+        }
+
+        assert(table.transcript_ids[i] < transcript_id_offsets.size());
+        compact_transcript_offsets.at(i) = transcript_id_offsets.at(table.transcript_ids[i]);
+    }
+
+    ofstream binary_ostream(filename, ios::binary);
+    assert(binary_ostream.is_open());
+
+    const uint64_t header[path_info_binary_header_size] = {path_info_binary_magic, path_info_binary_version | (static_cast<uint64_t>(has_haplotype_ids) << 32), fileSize(text_filename), fileModificationTime(text_filename), num_paths, table.num_haplotype_ids, compact_string_pool.size()};
+    binary_ostream.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    auto write_array = [&](const auto * values, const uint64_t num_values) {
+
+        binary_ostream.write(reinterpret_cast<const char *>(values), num_values * sizeof(*values));
+    };
+
+    write_array(compact_name_offsets.data(), num_paths);
+    write_array(compact_transcript_offsets.data(), num_paths);
+    write_array(table.haplotype_id_offsets, has_haplotype_ids ? num_paths + 1 : 0);
+
+    write_array(table.name_lengths, num_paths);
+    write_array(table.transcript_lengths, num_paths);
+    write_array(table.transcript_ids, num_paths);
+    write_array(table.haplotype_counts, num_paths);
+    write_array(table.sorted_path_indices, num_paths);
+    write_array(table.haplotype_ids, table.num_haplotype_ids);
+
+    write_array(compact_string_pool.data(), compact_string_pool.size());
+
+    assert(binary_ostream.good());
+    binary_ostream.close();
+}
+
+uint64_t PathInfoParser::numberOfPaths() const {
+
+    return table.num_paths;
+}
+
+bool PathInfoParser::hasHaplotypeIds() const {
+
+    return has_haplotype_ids;
+}
+
+bool PathInfoParser::pathInfo(PathInfo * path_info, const string & path_name, const bool parse_haplotype_ids, const bool use_transcript_names) const {
+
+    assert(!parse_haplotype_ids || has_haplotype_ids);
+
+    auto sorted_path_indices_it = lower_bound(table.sorted_path_indices, table.sorted_path_indices + table.num_paths, path_name, [&](const uint32_t path_idx, const string & name) {
+
+        return (compareNames(table.string_pool + table.name_offsets[path_idx], table.name_lengths[path_idx], name.data(), name.size()) < 0);
+    });
+
+    if (sorted_path_indices_it == table.sorted_path_indices + table.num_paths) {
+
+        return false;
+    }
+
+    const uint32_t path_idx = *sorted_path_indices_it;
+
+    if (compareNames(table.string_pool + table.name_offsets[path_idx], table.name_lengths[path_idx], path_name.data(), path_name.size()) != 0) {
+
+        return false;
+    }
+
+    if (use_transcript_names) {
+
+        path_info->name = string(table.string_pool + table.transcript_offsets[path_idx], table.transcript_lengths[path_idx]);
+
+    } else {
+
+        path_info->name = path_name;
+    }
+
+    path_info->group_id = table.transcript_ids[path_idx];
+    path_info->source_ids.clear();
+
+    if (parse_haplotype_ids) {
+
+        for (uint64_t i = table.haplotype_id_offsets[path_idx]; i < table.haplotype_id_offsets[path_idx + 1]; ++i) {
+
+            const bool is_new_haplotype_id = path_info->source_ids.emplace(table.haplotype_ids[i]).second;
+            assert(is_new_haplotype_id);
+        }
+
+        path_info->source_count = path_info->source_ids.size();
+
+    } else {
+
+        path_info->source_count = table.haplotype_counts[path_idx];
+    }
+
+    return true;
+}
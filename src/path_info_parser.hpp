@@ -0,0 +1,100 @@
+
+#ifndef RPVG_SRC_PATHINFOPARSER_HPP
+#define RPVG_SRC_PATHINFOPARSER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mio/mmap.hpp"
+
+#include "path_cluster_estimates.hpp"
+
+using namespace std;
+
+
+// Parser for the path haplotype/transcript information file (--write-info
+// output from vg rna). The text file is parsed in parallel blocks and the
+// parsed table can be written to, and memory-mapped from, a binary file.
+// A mapped table is used in place and path information is only created
+// for the paths that are looked up.
+class PathInfoParser {
+
+    public:
+
+        PathInfoParser(const uint32_t num_threads_in);
+
+        // Returns false if the file can not be opened or contains 
+        // duplicate path names. The table is empty in the latter case.
+        bool parseText(const string & filename, const bool parse_haplotype_ids);
+
+        // Loads binary table written by writeBinary. Returns false if the
+        // file is invalid or was created from a different text file (or 
+        // the text file has since been modified).
+        bool loadBinary(const string & filename, const string & text_filename);
+        void writeBinary(const string & filename, const string & text_filename) const;
+
+        uint64_t numberOfPaths() const;
+        bool hasHaplotypeIds() const;
+
+        // Returns false if the path is not in the table.
+        bool pathInfo(PathInfo * path_info, const string & path_name, const bool parse_haplotype_ids, const bool use_transcript_names) const;
+
+    private:
+
+        const uint32_t num_threads;
+
+        bool has_haplotype_ids;
+
+        // View of the table that either points to the parsed 
+        // vectors below or into the mapped binary file.
+        struct Table {
+
+            uint64_t num_paths;
+            uint64_t num_haplotype_ids;
+            uint64_t string_pool_size;
+
+            const char * string_pool;
+
+            const uint64_t * name_offsets;
+            const uint32_t * name_lengths;
+
+            const uint64_t * transcript_offsets;
+            const uint32_t * transcript_lengths;
+
+            const uint32_t * transcript_ids;
+            const uint32_t * haplotype_counts;
+
+            const uint64_t * haplotype_id_offsets;
+            const uint32_t * haplotype_ids;
+
+            // Path indices sorted by name.
+            const uint32_t * sorted_path_indices;
+        };
+
+        Table table;
+        mio::mmap_source binary_mmap;
+
+        // Names are stored as offsets into the string pool.
+        vector<char> string_pool;
+
+        vector<uint64_t> name_offsets;
+        vector<uint32_t> name_lengths;
+
+        vector<uint64_t> transcript_offsets;
+        vector<uint32_t> transcript_lengths;
+
+        vector<uint32_t> transcript_ids;
+        vector<uint32_t> haplotype_counts;
+
+        vector<uint64_t> haplotype_id_offsets;
+        vector<uint32_t> haplotype_ids;
+
+        vector<uint32_t> sorted_path_indices;
+
+        void setParsedTable();
+        void clear();
+};
+
+
+#endif
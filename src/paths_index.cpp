@@ -2,14 +2,24 @@
 #include "paths_index.hpp"
 
 #include <sstream>
+#include <fstream>
 #include <math.h>
+#include <queue>
+#include <functional>
+
+#include "sparsepp/spp.h"
 
 #include "utils.hpp"
+#include "read_stats.hpp"
+
+
+static const uint64_t node_lengths_magic = 0x5250564732444e4c;
+static const uint64_t node_path_clusters_magic = 0x525056474e50434c;
 
 
 PathsIndex::PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate & r_index_in, const vg::Graph & graph) : gbwt_index(gbwt_index_in), r_index(r_index_in) {
 
-    node_lengths = vector<int32_t>(graph.node_size() + 1, -1);
+    auto graph_node_lengths = vector<int32_t>(graph.node_size() + 1, -1);
     uint32_t max_node_id = 0;
 
     for (auto & node: graph.node()) {
@@ -17,22 +27,24 @@ PathsIndex::PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate
         auto id = node.id();
         max_node_id = max(max_node_id, static_cast<uint32_t>(id));
 
-        while (id >= node_lengths.size()) {
+        while (id >= graph_node_lengths.size()) {
 
-            node_lengths.resize(node_lengths.size() * 2, -1);
+            graph_node_lengths.resize(graph_node_lengths.size() * 2, -1);
         }
 
-        assert(node_lengths.at(id) == -1);
-        node_lengths.at(node.id()) = node.sequence().size();
+        assert(graph_node_lengths.at(id) == -1);
+        graph_node_lengths.at(node.id()) = node.sequence().size();
     }
 
-    assert(node_lengths.size() > max_node_id);
-    node_lengths.resize(max_node_id + 1);
+    assert(graph_node_lengths.size() > max_node_id);
+    graph_node_lengths.resize(max_node_id + 1);
+
+    setNodeLengths(graph_node_lengths);
 }
 
 PathsIndex::PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate & r_index_in,  const handlegraph::HandleGraph & graph) : gbwt_index(gbwt_index_in), r_index(r_index_in) {
 
-    node_lengths = vector<int32_t>(graph.get_node_count() + 1, -1);
+    auto graph_node_lengths = vector<int32_t>(graph.get_node_count() + 1, -1);
     uint32_t max_node_id = 0;
 
     assert(graph.for_each_handle([&](const handlegraph::handle_t & handle) {
@@ -40,19 +52,61 @@ PathsIndex::PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate
         auto id = graph.get_id(handle);
         max_node_id = max(max_node_id, static_cast<uint32_t>(id));
 
-        while (id >= node_lengths.size()) {
+        while (id >= graph_node_lengths.size()) {
 
-            node_lengths.resize(node_lengths.size() * 2, -1);
+            graph_node_lengths.resize(graph_node_lengths.size() * 2, -1);
         }
 
-        assert(node_lengths.at(id) == -1);
-        node_lengths.at(id) = graph.get_length(handle);
+        assert(graph_node_lengths.at(id) == -1);
+        graph_node_lengths.at(id) = graph.get_length(handle);
     }));
 
-    assert(node_lengths.size() > max_node_id);
-    node_lengths.resize(max_node_id + 1);
+    assert(graph_node_lengths.size() > max_node_id);
+    graph_node_lengths.resize(max_node_id + 1);
+
+    setNodeLengths(graph_node_lengths);
 } 
 
+PathsIndex::PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate & r_index_in, istream & node_lengths_istream) : gbwt_index(gbwt_index_in), r_index(r_index_in) {
+
+    uint64_t magic = 0;
+    node_lengths_istream.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+
+    assert(magic == node_lengths_magic);
+    node_lengths.load(node_lengths_istream);
+
+    assert(node_lengths_istream.good());
+}
+
+bool PathsIndex::isNodeLengthsFile(const string & filename) {
+
+    ifstream node_lengths_istream(filename, ios::binary);
+
+    uint64_t magic = 0;
+    node_lengths_istream.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+
+    return (node_lengths_istream.good() && magic == node_lengths_magic);
+}
+
+void PathsIndex::serializeNodeLengths(ostream & out) const {
+
+    out.write(reinterpret_cast<const char *>(&node_lengths_magic), sizeof(node_lengths_magic));
+    node_lengths.serialize(out);
+}
+
+void PathsIndex::setNodeLengths(const vector<int32_t> & node_lengths_in) {
+
+    node_lengths = sdsl::int_vector<>(node_lengths_in.size(), 0);
+
+    for (size_t i = 0; i < node_lengths_in.size(); ++i) {
+
+        assert(node_lengths_in.at(i) >= -1);
+        node_lengths[i] = node_lengths_in.at(i) + 1;
+    }
+
+    sdsl::util::bit_compress(node_lengths);
+}
+
 uint32_t PathsIndex::numberOfNodes() const {
 
     return node_lengths.size();
@@ -65,13 +119,13 @@ bool PathsIndex::hasNodeId(const uint32_t node_id) const {
         return false;
     }
 
-    return (node_lengths.at(node_id) != -1);
+    return (node_lengths[node_id] != 0);
 }
         
 uint32_t PathsIndex::nodeLength(const uint32_t node_id) const {
 
     assert(hasNodeId(node_id));
-    return node_lengths.at(node_id);
+    return node_lengths[node_id] - 1;
 }
 
 vector<gbwt::edge_type> PathsIndex::edges(const gbwt::node_type gbwt_node) const {
@@ -79,11 +133,240 @@ vector<gbwt::edge_type> PathsIndex::edges(const gbwt::node_type gbwt_node) const
     return gbwt_index.edges(gbwt_node);
 }
 
+void PathsIndex::buildPredecessorIndex() {
+
+    const gbwt::node_type num_gbwt_nodes = gbwt::Node::encode(numberOfNodes(), false);
+    vector<uint64_t> offsets(num_gbwt_nodes + 1, 0);
+
+    for (uint32_t node_id = 1; node_id < numberOfNodes(); ++node_id) {
+
+        for (auto & gbwt_node: {gbwt::Node::encode(node_id, false), gbwt::Node::encode(node_id, true)}) {
+
+            if (!hasNodeId(node_id) || !gbwt_index.contains(gbwt_node)) {
+
+                continue;
+            }
+
+            for (auto & edge: gbwt_index.edges(gbwt_node)) {
+
+                if (edge.first != gbwt::ENDMARKER && edge.first < num_gbwt_nodes) {
+
+                    ++offsets.at(edge.first + 1);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 1; i < offsets.size(); ++i) {
+
+        offsets.at(i) += offsets.at(i - 1);
+    }
+
+    vector<uint64_t> next_predecessor_idx(offsets.begin(), offsets.end() - 1);
+    predecessors = sdsl::int_vector<>(offsets.back(), 0, gbwt::bit_length(num_gbwt_nodes));
+
+    for (uint32_t node_id = 1; node_id < numberOfNodes(); ++node_id) {
+
+        for (auto & gbwt_node: {gbwt::Node::encode(node_id, false), gbwt::Node::encode(node_id, true)}) {
+
+            if (!hasNodeId(node_id) || !gbwt_index.contains(gbwt_node)) {
+
+                continue;
+            }
+
+            for (auto & edge: gbwt_index.edges(gbwt_node)) {
+
+                if (edge.first != gbwt::ENDMARKER && edge.first < num_gbwt_nodes) {
+
+                    predecessors[next_predecessor_idx.at(edge.first)] = gbwt_node;
+                    ++next_predecessor_idx.at(edge.first);
+                }
+            }
+        }
+    }
+
+    predecessor_offsets = sdsl::int_vector<>(offsets.size(), 0, gbwt::bit_length(offsets.back()));
+
+    for (size_t i = 0; i < offsets.size(); ++i) {
+
+        predecessor_offsets[i] = offsets.at(i);
+    }
+}
+
+bool PathsIndex::hasPredecessorIndex() const {
+
+    return !predecessor_offsets.empty();
+}
+
+void PathsIndex::minTargetDistances(spp::sparse_hash_map<gbwt::node_type, uint32_t> * target_distances, const vector<gbwt::node_type> & target_nodes, const uint32_t max_distance) const {
+
+    assert(hasPredecessorIndex());
+    target_distances->clear();
+
+    // Bounded backward Dijkstra search from the target nodes. The queue is 
+    // empty after each search and its storage is reused by the next search.
+    thread_local priority_queue<pair<uint32_t, gbwt::node_type>, vector<pair<uint32_t, gbwt::node_type> >, greater<pair<uint32_t, gbwt::node_type> > > distance_queue;
+    assert(distance_queue.empty());
+
+    auto add_predecessors = [&](const gbwt::node_type gbwt_node, const uint32_t distance) {
+
+        if (gbwt_node + 1 >= predecessor_offsets.size()) {
+
+            return;
+        }
+
+        for (uint64_t i = predecessor_offsets[gbwt_node]; i < predecessor_offsets[gbwt_node + 1]; ++i) {
+
+            auto target_distances_it = target_distances->emplace(predecessors[i], distance);
+
+            if (target_distances_it.second || distance < target_distances_it.first->second) {
+
+                target_distances_it.first->second = distance;
+                distance_queue.emplace(distance, predecessors[i]);
+            }
+        }
+    };
+
+    for (auto & target_node: target_nodes) {
+
+        add_predecessors(target_node, 0);
+    }
+
+    while (!distance_queue.empty()) {
+
+        const pair<uint32_t, gbwt::node_type> cur_distance = distance_queue.top();
+        distance_queue.pop();
+
+        if (target_distances->at(cur_distance.second) < cur_distance.first) {
+
+            continue;
+        }
+
+        const uint32_t distance = cur_distance.first + nodeLength(gbwt::Node::id(cur_distance.second));
+
+        if (distance <= max_distance) {
+
+            add_predecessors(cur_distance.second, distance);
+        }
+    }
+}
+
+void PathsIndex::uniteNodePaths(ConcurrentUnionFind * connected_paths, const uint32_t num_threads) const {
+
+    assert(connected_paths->size() == numberOfPaths());
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (size_t i = 1; i <= numberOfNodes(); ++i) {
+
+        vector<vector<gbwt::size_type> > node_path_id_sets;
+
+        pair<gbwt::SearchState, gbwt::size_type> gbwt_search;
+        find(&gbwt_search, gbwt::Node::encode(i, false));
+
+        if (!gbwt_search.first.empty()) {
+
+            node_path_id_sets.emplace_back(locatePathIds(gbwt_search));
+        }
+
+        // Both orientations of a node are visited by
+        // the same paths in a bidirectional index.
+        if (!bidirectional()) {
+
+            find(&gbwt_search, gbwt::Node::encode(i, true));
+
+            if (!gbwt_search.first.empty()) {
+
+                node_path_id_sets.emplace_back(locatePathIds(gbwt_search));
+            }
+        }
+
+        for (auto & node_path_ids: node_path_id_sets) {
+
+            for (auto & path_id: node_path_ids) {
+
+                connected_paths->unite(node_path_ids.front(), path_id);
+            }
+        }
+    }
+}
+
+void PathsIndex::buildNodePathClusters(const uint32_t num_threads) {
+
+    ConcurrentUnionFind connected_paths(numberOfPaths());
+    uniteNodePaths(&connected_paths, num_threads);
+
+    node_path_clusters = sdsl::int_vector<>(numberOfPaths(), 0);
+
+    vector<uint32_t> root_to_cluster_index(numberOfPaths(), -1);
+    uint32_t num_clusters = 0;
+
+    for (uint32_t i = 0; i < numberOfPaths(); ++i) {
+
+        auto root_path = connected_paths.find(i);
+
+        if (root_to_cluster_index.at(root_path) == -1) {
+
+            root_to_cluster_index.at(root_path) = num_clusters;
+            ++num_clusters;
+        }
+
+        node_path_clusters[i] = root_to_cluster_index.at(root_path);
+    }
+
+    sdsl::util::bit_compress(node_path_clusters);
+}
+
+bool PathsIndex::loadNodePathClusters(istream & in) {
+
+    uint64_t header[3];
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+
+    // The paths are identified by their number and the length of the GBWT.
+    if (!in.good() || header[0] != node_path_clusters_magic || header[1] != numberOfPaths() || header[2] != gbwt_index.size()) {
+
+        return false;
+    }
+
+    node_path_clusters.load(in);
+
+    if (!in.good() || node_path_clusters.size() != numberOfPaths()) {
+
+        node_path_clusters = sdsl::int_vector<>();
+        return false;
+    }
+
+    return true;
+}
+
+void PathsIndex::serializeNodePathClusters(ostream & out) const {
+
+    const uint64_t header[3] = {node_path_clusters_magic, numberOfPaths(), gbwt_index.size()};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    node_path_clusters.serialize(out);
+}
+
+bool PathsIndex::hasNodePathClusters() const {
+
+    return (node_path_clusters.size() == numberOfPaths() && numberOfPaths() > 0);
+}
+
+uint32_t PathsIndex::nodePathCluster(const uint32_t path_id) const {
+
+    assert(hasNodePathClusters());
+    return node_path_clusters[path_id];
+}
+
 bool PathsIndex::bidirectional() const {
 
     return gbwt_index.bidirectional();
 }
 
+bool PathsIndex::hasRIndex() const {
+
+    return !r_index.empty();
+}
+
 uint32_t PathsIndex::numberOfPaths() const {
 
     if (bidirectional()) {
@@ -99,6 +382,8 @@ uint32_t PathsIndex::numberOfPaths() const {
 
 void PathsIndex::find(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, const gbwt::node_type gbwt_node) const {
 
+    ADD_READ_COST(num_find_calls, 1);
+
     if (r_index.empty()) {
 
         gbwt_search->first = gbwt_index.find(gbwt_node);
@@ -111,6 +396,8 @@ void PathsIndex::find(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, co
 
 void PathsIndex::extend(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, const gbwt::node_type gbwt_node) const {
 
+    ADD_READ_COST(num_extend_calls, 1);
+
     if (r_index.empty()) {
 
         gbwt_search->first = gbwt_index.extend(gbwt_search->first, gbwt_node);
@@ -121,8 +408,21 @@ void PathsIndex::extend(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search,
     }
 }
 
+void PathsIndex::extend(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, const gbwt::node_type gbwt_node, GBWTSearchCache * search_cache) const {
+
+    if (!search_cache->find(*gbwt_search, gbwt_node, gbwt_search)) {
+
+        const pair<gbwt::SearchState, gbwt::size_type> prev_gbwt_search = *gbwt_search;
+        
+        extend(gbwt_search, gbwt_node);
+        search_cache->insert(prev_gbwt_search, gbwt_node, *gbwt_search);
+    }
+}
+
 vector<gbwt::size_type> PathsIndex::locatePathIds(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const {
 
+    ADD_READ_COST(num_locate_calls, 1);
+
     vector<gbwt::size_type> path_ids;
 
     if (r_index.empty()) {
@@ -228,3 +528,63 @@ double PathsIndex::calculateUpperPhi(const double value) const {
     return (0.5 * (1 + erf(value / sqrt(2))));
 }
 
+
+GBWTSearchCache::GBWTSearchCache(const uint32_t num_entries_log2) : entry_mask((static_cast<uint64_t>(1) << num_entries_log2) - 1), num_lookups(0), num_hits(0) {
+
+    // Entries with the end marker as extending node are empty.
+    Entry empty_entry;
+    empty_entry.gbwt_node = gbwt::ENDMARKER;
+
+    entries = vector<Entry>(entry_mask + 1, empty_entry);
+}
+
+bool GBWTSearchCache::find(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search, const gbwt::node_type gbwt_node, pair<gbwt::SearchState, gbwt::size_type> * extended_gbwt_search) {
+
+    assert(gbwt_node != gbwt::ENDMARKER);
+    ++num_lookups;
+
+    const Entry & entry = entries[entryIndex(gbwt_search, gbwt_node)];
+
+    if (entry.gbwt_node == gbwt_node && entry.gbwt_search == gbwt_search) {
+
+        ++num_hits;
+        *extended_gbwt_search = entry.extended_gbwt_search;
+
+        return true;
+    }
+
+    return false;
+}
+
+void GBWTSearchCache::insert(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search, const gbwt::node_type gbwt_node, const pair<gbwt::SearchState, gbwt::size_type> & extended_gbwt_search) {
+
+    assert(gbwt_node != gbwt::ENDMARKER);
+    Entry & entry = entries[entryIndex(gbwt_search, gbwt_node)];
+
+    entry.gbwt_search = gbwt_search;
+    entry.gbwt_node = gbwt_node;
+    entry.extended_gbwt_search = extended_gbwt_search;
+}
+
+uint64_t GBWTSearchCache::lookups() const {
+
+    return num_lookups;
+}
+
+uint64_t GBWTSearchCache::hits() const {
+
+    return num_hits;
+}
+
+uint64_t GBWTSearchCache::entryIndex(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search, const gbwt::node_type gbwt_node) const {
+
+    size_t seed = 0;
+
+    spp::hash_combine(seed, gbwt_search.first.node);
+    spp::hash_combine(seed, gbwt_search.first.range.first);
+    spp::hash_combine(seed, gbwt_search.first.range.second);
+    spp::hash_combine(seed, gbwt_search.second);
+    spp::hash_combine(seed, gbwt_node);
+
+    return (seed & entry_mask);
+}
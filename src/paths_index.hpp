@@ -7,19 +7,62 @@
 
 #include "gbwt/gbwt.h"
 #include "gbwt/fast_locate.h"
+#include "sdsl/int_vector.hpp"
+#include "sparsepp/spp.h"
 #include "handlegraph/handle_graph.hpp"
 #include "vg/io/basic_stream.hpp"
 #include "fragment_length_dist.hpp"
+#include "concurrent_union_find.hpp"
 
 using namespace std;
 
 
+// Bounded direct-mapped cache of extended GBWT (or r-index) searches keyed 
+// by the search and the extending node. A cache should only be used by 
+// one thread at a time and only with the index it was filled from. Caches
+// of different threads are stored next to each other and are therefore 
+// aligned to cache lines.
+class alignas(64) GBWTSearchCache {
+
+    public:
+
+        GBWTSearchCache(const uint32_t num_entries_log2);
+
+        bool find(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search, const gbwt::node_type gbwt_node, pair<gbwt::SearchState, gbwt::size_type> * extended_gbwt_search);
+        void insert(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search, const gbwt::node_type gbwt_node, const pair<gbwt::SearchState, gbwt::size_type> & extended_gbwt_search);
+
+        uint64_t lookups() const;
+        uint64_t hits() const;
+
+    private:
+
+        struct Entry {
+
+            pair<gbwt::SearchState, gbwt::size_type> gbwt_search;
+            gbwt::node_type gbwt_node;
+
+            pair<gbwt::SearchState, gbwt::size_type> extended_gbwt_search;
+        };
+
+        vector<Entry> entries;
+        const uint64_t entry_mask;
+
+        uint64_t num_lookups;
+        uint64_t num_hits;
+
+        uint64_t entryIndex(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search, const gbwt::node_type gbwt_node) const;
+};
+
 class PathsIndex {
 
     public: 
     	
         PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate & r_index_in, const vg::Graph & graph);
         PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate & r_index_in, const handlegraph::HandleGraph & graph);
+        PathsIndex(const gbwt::GBWT & gbwt_index_in, const gbwt::FastLocate & r_index_in, istream & node_lengths_istream);
+
+        static bool isNodeLengthsFile(const string & filename);
+        void serializeNodeLengths(ostream & out) const;
 
         uint32_t numberOfNodes() const;
         bool hasNodeId(const uint32_t node_id) const;
@@ -27,11 +70,37 @@ class PathsIndex {
 
         vector<gbwt::edge_type> edges(const gbwt::node_type gbwt_node) const;
 
+        // Builds index of the predecessors of each node used to 
+        // calculate lower bounds on distances between nodes.
+        void buildPredecessorIndex();
+        bool hasPredecessorIndex() const;
+
+        // Calculates the minimum summed length of the nodes visited between  
+        // each node and the closest target node (excluding both). Only 
+        // nodes with a distance of at most max_distance are included.
+        void minTargetDistances(spp::sparse_hash_map<gbwt::node_type, uint32_t> * target_distances, const vector<gbwt::node_type> & target_nodes, const uint32_t max_distance) const;
+
+        // Unites the paths visiting each node (in either orientation).
+        void uniteNodePaths(ConcurrentUnionFind * connected_paths, const uint32_t num_threads) const;
+
+        // Builds index of the clusters of paths sharing a node. The index 
+        // only depends on the paths and can be serialized and loaded 
+        // instead of clustering the paths again in later runs. Loading 
+        // fails if the index was built from different paths.
+        void buildNodePathClusters(const uint32_t num_threads);
+        bool loadNodePathClusters(istream & in);
+        void serializeNodePathClusters(ostream & out) const;
+
+        bool hasNodePathClusters() const;
+        uint32_t nodePathCluster(const uint32_t path_id) const;
+
         bool bidirectional() const;
+        bool hasRIndex() const;
         uint32_t numberOfPaths() const;
 
         void find(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, const gbwt::node_type gbwt_node) const;
         void extend(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, const gbwt::node_type gbwt_node) const;
+        void extend(pair<gbwt::SearchState, gbwt::size_type> * gbwt_search, const gbwt::node_type gbwt_node, GBWTSearchCache * search_cache) const;
         vector<gbwt::size_type> locatePathIds(const pair<gbwt::SearchState, gbwt::size_type> & gbwt_search) const;
 
         string pathName(const uint32_t path_id) const;
@@ -43,7 +112,19 @@ class PathsIndex {
         const gbwt::GBWT & gbwt_index;
         const gbwt::FastLocate & r_index;
 
-        vector<int32_t> node_lengths;
+        // Node lengths plus one indexed by node id (zero for missing ids).
+        sdsl::int_vector<> node_lengths;
+
+        // Predecessors of node x are at predecessor_offsets[x] to 
+        // predecessor_offsets[x + 1] (compressed sparse row layout).
+        sdsl::int_vector<> predecessor_offsets;
+        sdsl::int_vector<> predecessors;
+
+        // Cluster id of each path, where paths sharing a node are
+        // in the same cluster (numbered by smallest path id).
+        sdsl::int_vector<> node_path_clusters;
+
+        void setNodeLengths(const vector<int32_t> & node_lengths_in);
 
         double calculateLowerPhi(const double value) const;
         double calculateUpperPhi(const double value) const;
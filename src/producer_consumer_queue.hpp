@@ -46,8 +46,10 @@ class ProducerConsumerQueue {
 
 		ProducerConsumerQueue(uint32_t); // Argument - max buffer size
 		void push(Data);
+		bool tryPush(Data);
 		void pushedLast();
 		bool pop(Data *);
+		bool tryPop(Data *);
 
 	private:
 
@@ -55,6 +55,24 @@ void ProducerConsumerQueue<Data>::push(Data data) {
     consumer_cv.notify_one();
 }
 
+template<typename Data> 
+bool ProducerConsumerQueue<Data>::tryPush(Data data) {
+
+    std::unique_lock<std::mutex> queue_lock(queue_mutex);                              
+                
+	if (queue.size() == max_buffer_size) {
+
+        return false;
+   	}
+
+    queue.push_back(data);
+    queue_lock.unlock();
+
+    consumer_cv.notify_one();
+
+    return true;
+}
+
 template<typename Data>
 void ProducerConsumerQueue<Data>::pushedLast() {
 
@@ -87,4 +105,23 @@ bool ProducerConsumerQueue<Data>::pop(Data * data) {
     producer_cv.notify_one();
 
     return true;
-}
\ No newline at end of file
+}
+
+template<typename Data>
+bool ProducerConsumerQueue<Data>::tryPop(Data * data) {
+
+    std::unique_lock<std::mutex> queue_lock(queue_mutex);
+
+    if (queue.size() == 0) {
+
+        return false;
+    }
+    
+    (*data) = queue.front();
+    queue.pop_front();
+	queue_lock.unlock();
+
+    producer_cv.notify_one();
+
+    return true;
+}
@@ -36,7 +36,7 @@ const vector<pair<double, vector<uint32_t> > > & ReadPathProbabilities::pathProb
     return path_probs;
 }
 
-vector<double> ReadPathProbabilities::calcAlignPathLogProbs(const vector<AlignmentPath> & align_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end) {
+vector<double> ReadPathProbabilities::calcAlignPathLogProbs(const AlignmentPathSpan & align_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end) {
 
     assert(align_paths.size() > 1);
 
@@ -71,7 +71,7 @@ void ReadPathProbabilities::addReadCount(const uint32_t read_count_in) {
     read_count += read_count_in;
 }
 
-void ReadPathProbabilities::addPathProbs(const vector<AlignmentPath> & align_paths, const vector<vector<gbwt::size_type> > & align_paths_ids, const spp::sparse_hash_map<uint32_t, uint32_t> & clustered_path_index, const vector<PathInfo> & cluster_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end, const double min_noise_prob, const bool collapse_groups, const spp::sparse_hash_map<string, uint32_t> & group_name_index) {
+void ReadPathProbabilities::addPathProbs(const AlignmentPathSpan & align_paths, const vector<vector<gbwt::size_type> > & align_paths_ids, const spp::sparse_hash_map<uint32_t, uint32_t> & clustered_path_index, const vector<PathInfo> & cluster_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end, const double min_noise_prob, const bool collapse_groups, const spp::sparse_hash_map<string, uint32_t> & group_name_index) {
 
     assert(align_paths.size() > 1);
     assert(align_paths.size() == align_paths_ids.size());
@@ -27,10 +27,10 @@ class ReadPathProbabilities {
         double noiseProb() const;
         const vector<pair<double, vector<uint32_t> > > & pathProbs() const;
 
-        static vector<double> calcAlignPathLogProbs(const vector<AlignmentPath> & align_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end);
+        static vector<double> calcAlignPathLogProbs(const AlignmentPathSpan & align_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end);
 
         void addReadCount(const uint32_t read_count_in);
-        void addPathProbs(const vector<AlignmentPath> & align_paths, const vector<vector<gbwt::size_type> > & align_paths_ids, const spp::sparse_hash_map<uint32_t, uint32_t> & clustered_path_index, const vector<PathInfo> & cluster_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end, const double min_noise_prob, const bool collapse_groups = false, const spp::sparse_hash_map<string, uint32_t> & group_name_index = spp::sparse_hash_map<string, uint32_t>());
+        void addPathProbs(const AlignmentPathSpan & align_paths, const vector<vector<gbwt::size_type> > & align_paths_ids, const spp::sparse_hash_map<uint32_t, uint32_t> & clustered_path_index, const vector<PathInfo> & cluster_paths, const FragmentLengthDist & fragment_length_dist, const bool is_single_end, const double min_noise_prob, const bool collapse_groups = false, const spp::sparse_hash_map<string, uint32_t> & group_name_index = spp::sparse_hash_map<string, uint32_t>());
 
         bool quickMergeIdentical(const ReadPathProbabilities & probs_2);
 
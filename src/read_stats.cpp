@@ -0,0 +1,137 @@
+
+#include "read_stats.hpp"
+
+#include <assert.h>
+#include <algorithm>
+#include <functional>
+
+
+static const vector<string> read_cost_names = {"expanded_nodes", "find_calls", "extend_calls", "locate_calls", "search_paths", "time_us"};
+
+#ifdef RPVG_READ_STATS
+
+thread_local ReadCosts thread_read_costs;
+
+#endif
+
+ReadStats::ReadStats(const uint32_t max_num_top_reads_in) : max_num_top_reads(max_num_top_reads_in), num_reads(0), histograms(read_cost_names.size()) {}
+
+void ReadStats::add(const string & read_name, const ReadCosts & read_costs) {
+
+    ++num_reads;
+
+    addToHistogram(0, read_costs.num_expanded_nodes);
+    addToHistogram(1, read_costs.num_find_calls);
+    addToHistogram(2, read_costs.num_extend_calls);
+    addToHistogram(3, read_costs.num_locate_calls);
+    addToHistogram(4, read_costs.num_search_paths);
+    addToHistogram(5, static_cast<uint64_t>(read_costs.time * 1e6));
+
+    addTopRead(read_costs.time, read_name);
+}
+
+void ReadStats::merge(const ReadStats & read_stats) {
+
+    assert(histograms.size() == read_stats.histograms.size());
+    num_reads += read_stats.num_reads;
+
+    for (size_t i = 0; i < histograms.size(); ++i) {
+
+        if (histograms.at(i).size() < read_stats.histograms.at(i).size()) {
+
+            histograms.at(i).resize(read_stats.histograms.at(i).size(), 0);
+        }
+
+        for (size_t j = 0; j < read_stats.histograms.at(i).size(); ++j) {
+
+            histograms.at(i).at(j) += read_stats.histograms.at(i).at(j);
+        }
+    }
+
+    for (auto & top_read: read_stats.top_reads) {
+
+        addTopRead(top_read.first, top_read.second);
+    }
+}
+
+uint64_t ReadStats::numReads() const {
+
+    return num_reads;
+}
+
+const vector<uint64_t> & ReadStats::histogram(const uint32_t cost_idx) const {
+
+    return histograms.at(cost_idx);
+}
+
+const vector<pair<double, string> > & ReadStats::topReads() const {
+
+    return top_reads;
+}
+
+void ReadStats::writeReport(ostream & out) const {
+
+    out << "#Histograms (" << num_reads << " reads)" << endl;
+    out << "Cost\tMinValue\tMaxValue\tCount" << endl;
+
+    for (size_t i = 0; i < histograms.size(); ++i) {
+
+        for (size_t j = 0; j < histograms.at(i).size(); ++j) {
+
+            if (histograms.at(i).at(j) > 0) {
+
+                out << read_cost_names.at(i) << "\t" << (j == 0 ? 0 : (static_cast<uint64_t>(1) << (j - 1))) << "\t" << (j == 0 ? 0 : (static_cast<uint64_t>(1) << j) - 1) << "\t" << histograms.at(i).at(j) << endl;
+            }
+        }
+    }
+
+    auto sorted_top_reads = top_reads;
+    sort(sorted_top_reads.rbegin(), sorted_top_reads.rend());
+
+    out << "#Top reads" << endl;
+    out << "Name\tTime" << endl;
+
+    for (auto & top_read: sorted_top_reads) {
+
+        out << top_read.second << "\t" << top_read.first << endl;
+    }
+}
+
+void ReadStats::addToHistogram(const uint32_t cost_idx, const uint64_t value) {
+
+    uint32_t bin_idx = 0;
+
+    while (bin_idx < 64 && (value >> bin_idx) > 0) {
+
+        ++bin_idx;
+    }
+
+    auto & histogram = histograms.at(cost_idx);
+
+    if (histogram.size() <= bin_idx) {
+
+        histogram.resize(bin_idx + 1, 0);
+    }
+
+    ++histogram.at(bin_idx);
+}
+
+void ReadStats::addTopRead(const double time, const string & read_name) {
+
+    if (max_num_top_reads == 0) {
+
+        return;
+    }
+
+    if (top_reads.size() < max_num_top_reads) {
+
+        top_reads.emplace_back(time, read_name);
+        push_heap(top_reads.begin(), top_reads.end(), greater<pair<double, string> >());
+
+    } else if (time > top_reads.front().first) {
+
+        pop_heap(top_reads.begin(), top_reads.end(), greater<pair<double, string> >());
+        top_reads.back() = make_pair(time, read_name);
+        push_heap(top_reads.begin(), top_reads.end(), greater<pair<double, string> >());
+    }
+}
@@ -0,0 +1,76 @@
+
+#ifndef RPVG_SRC_READSTATS_HPP
+#define RPVG_SRC_READSTATS_HPP
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+
+// Costs of finding the alignment paths of a single read (pair). The costs
+// are only counted when compiled with RPVG_READ_STATS defined (cmake
+// -DREAD_STATS=1), otherwise ADD_READ_COST compiles to nothing.
+struct ReadCosts {
+
+    uint64_t num_expanded_nodes;
+
+    uint64_t num_find_calls;
+    uint64_t num_extend_calls;
+    uint64_t num_locate_calls;
+
+    uint64_t num_search_paths;
+    double time;
+
+    ReadCosts() : num_expanded_nodes(0), num_find_calls(0), num_extend_calls(0), num_locate_calls(0), num_search_paths(0), time(0) {}
+};
+
+#ifdef RPVG_READ_STATS
+
+// Costs of the read (pair) currently processed by each thread.
+extern thread_local ReadCosts thread_read_costs;
+
+#define ADD_READ_COST(cost, value) (thread_read_costs.cost += (value))
+
+#else
+
+#define ADD_READ_COST(cost, value)
+
+#endif
+
+// Histograms of read costs (log2 bins) and the most expensive reads
+// measured by time.
+class ReadStats {
+
+    public:
+
+        ReadStats(const uint32_t max_num_top_reads_in);
+
+        void add(const string & read_name, const ReadCosts & read_costs);
+        void merge(const ReadStats & read_stats);
+
+        uint64_t numReads() const;
+        const vector<uint64_t> & histogram(const uint32_t cost_idx) const;
+        const vector<pair<double, string> > & topReads() const;
+
+        void writeReport(ostream & out) const;
+
+    private:
+
+        const uint32_t max_num_top_reads;
+        uint64_t num_reads;
+
+        // Bin 0 contains zero costs and bin i > 0 costs in [2^(i-1), 2^i).
+        // Times are binned in microseconds.
+        vector<vector<uint64_t> > histograms;
+
+        // Min-heap on time of the most expensive reads.
+        vector<pair<double, string> > top_reads;
+
+        void addToHistogram(const uint32_t cost_idx, const uint64_t value);
+        void addTopRead(const double time, const string & read_name);
+};
+
+
+#endif
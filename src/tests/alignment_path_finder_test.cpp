@@ -5,6 +5,7 @@
 #include "gbwt/fast_locate.h"
 
 #include "../alignment_path_finder.hpp"
+#include "../lean_alignment_parser.hpp"
 #include "../utils.hpp"
 
 
@@ -98,7 +99,7 @@ TEST_CASE("Alignment path(s) can be found from a single-end alignment") {
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 3);
 
-    AlignmentPathFinder<vg::Alignment> alignment_path_finder(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0);
+    AlignmentPathFinder<vg::Alignment> alignment_path_finder(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
 
     auto alignment_paths = alignment_path_finder.findAlignmentPaths(alignment_1);
     REQUIRE(alignment_paths.size() == 3);
@@ -127,6 +128,51 @@ TEST_CASE("Alignment path(s) can be found from a single-end alignment") {
         REQUIRE(alignment_paths.back().score_sum == numeric_limits<int32_t>::lowest());
     }
 
+    SECTION("Duplicate single-end read alignments have the same deduplication key and alignment path(s)") {
+
+        AlignmentDedupKeyBuilder dedup_key_builder(vg::Alignment::descriptor(), vector<string>({"sequence", "quality", "path", "mapping_quality", "score", "annotation"}), vector<string>({"allelic_mapq"}));
+
+        alignment_1.set_name("read1");
+        (*alignment_1.mutable_annotation()->mutable_fields())["allelic_mapq"].set_number_value(5);
+        (*alignment_1.mutable_annotation()->mutable_fields())["proper_pair"].set_bool_value(true);
+
+        vg::Alignment alignment_1_dup;
+        alignment_1_dup.set_name("read2");
+        (*alignment_1_dup.mutable_annotation()->mutable_fields())["proper_pair"].set_bool_value(false);
+        (*alignment_1_dup.mutable_annotation()->mutable_fields())["allelic_mapq"].set_number_value(5);
+
+        alignment_1_dup.set_sequence(alignment_1.sequence());
+        *(alignment_1_dup.mutable_path()) = alignment_1.path();
+        alignment_1_dup.set_mapping_quality(alignment_1.mapping_quality());
+        alignment_1_dup.set_score(alignment_1.score());
+
+        dedup_key_builder.clear();
+        dedup_key_builder.addAlignment(alignment_1);
+
+        const pair<uint64_t, uint64_t> dedup_key = dedup_key_builder.key();
+
+        dedup_key_builder.clear();
+        dedup_key_builder.addAlignment(alignment_1_dup);
+
+        REQUIRE(dedup_key_builder.key() == dedup_key);
+        REQUIRE(alignment_path_finder.findAlignmentPaths(alignment_1_dup) == alignment_path_finder.findAlignmentPaths(alignment_1));
+
+        alignment_1_dup.set_mapping_quality(alignment_1.mapping_quality() + 1);
+
+        dedup_key_builder.clear();
+        dedup_key_builder.addAlignment(alignment_1_dup);
+
+        REQUIRE(dedup_key_builder.key() != dedup_key);
+
+        alignment_1_dup.set_mapping_quality(alignment_1.mapping_quality());
+        (*alignment_1_dup.mutable_annotation()->mutable_fields())["allelic_mapq"].set_number_value(6);
+
+        dedup_key_builder.clear();
+        dedup_key_builder.addAlignment(alignment_1_dup);
+
+        REQUIRE(dedup_key_builder.key() != dedup_key);
+    }
+
     SECTION("Reverse-complement single-end read alignment finds alignment path(s)") {
 
         auto alignment_1_rc = Utils::lazy_reverse_complement_alignment(alignment_1, node_frag_length_func);
@@ -138,6 +184,17 @@ TEST_CASE("Alignment path(s) can be found from a single-end alignment") {
         REQUIRE(alignment_paths_rc == alignment_paths);
     }
 
+    SECTION("Reverse-complement single-end read alignment can be written to existing alignment") {
+
+        auto alignment_1_rc = Utils::lazy_reverse_complement_alignment(alignment_1, node_frag_length_func);
+
+        vg::Alignment alignment_1_rc_reused = alignment_1_rc;
+        alignment_1_rc_reused.mutable_path()->add_mapping()->mutable_position()->set_node_id(4);
+
+        Utils::lazy_reverse_complement_alignment(alignment_1, node_frag_length_func, &alignment_1_rc_reused);
+        REQUIRE(alignment_1_rc_reused.SerializeAsString() == alignment_1_rc.SerializeAsString());
+    }
+
     SECTION("Soft-clipped single-end read alignment finds alignment path(s)") {
 
         alignment_1.mutable_path()->mutable_mapping(0)->mutable_edit(0)->set_from_length(1);
@@ -200,7 +257,7 @@ TEST_CASE("Alignment path(s) can be found from a single-end alignment") {
         REQUIRE(paths_index_bd.bidirectional());
         REQUIRE(paths_index_bd.numberOfPaths() == 2);
 
-        AlignmentPathFinder<vg::Alignment> alignment_path_finder_bd(paths_index_bd, "unstranded", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::Alignment> alignment_path_finder_bd(paths_index_bd, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
     
         auto alignment_paths_bd = alignment_path_finder_bd.findAlignmentPaths(alignment_1);
         REQUIRE(alignment_paths_bd.size() == 2);
@@ -342,7 +399,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end alignment") {
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 4);
 
-    AlignmentPathFinder<vg::Alignment> alignment_path_finder(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0);
+    AlignmentPathFinder<vg::Alignment> alignment_path_finder(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
     
     auto alignment_paths = alignment_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2);
     REQUIRE(alignment_paths.size() == 4);
@@ -378,6 +435,27 @@ TEST_CASE("Alignment path(s) can be found from a paired-end alignment") {
         REQUIRE(alignment_paths.back().score_sum == numeric_limits<int32_t>::lowest());
     }
 
+    SECTION("Paired-end read alignment finds same alignment path(s) with node distance lower bounds") {
+
+        AlignmentPathFinder<vg::Alignment> alignment_path_finder_19(paths_index, 1, "unstranded", true, false, 19, 0, true, 20, 0);
+        AlignmentPathFinder<vg::Alignment> alignment_path_finder_17(paths_index, 1, "unstranded", true, false, 17, 0, true, 20, 0);
+        AlignmentPathFinder<vg::Alignment> alignment_path_finder_10(paths_index, 1, "unstranded", true, false, 10, 0, true, 20, 0);
+
+        auto alignment_paths_19 = alignment_path_finder_19.findPairedAlignmentPaths(alignment_1, alignment_2);
+        auto alignment_paths_17 = alignment_path_finder_17.findPairedAlignmentPaths(alignment_1, alignment_2);
+        auto alignment_paths_10 = alignment_path_finder_10.findPairedAlignmentPaths(alignment_1, alignment_2);
+
+        REQUIRE(!paths_index.hasPredecessorIndex());
+
+        paths_index.buildPredecessorIndex();
+        REQUIRE(paths_index.hasPredecessorIndex());
+
+        REQUIRE(alignment_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2) == alignment_paths);
+        REQUIRE(alignment_path_finder_19.findPairedAlignmentPaths(alignment_1, alignment_2) == alignment_paths_19);
+        REQUIRE(alignment_path_finder_17.findPairedAlignmentPaths(alignment_1, alignment_2) == alignment_paths_17);
+        REQUIRE(alignment_path_finder_10.findPairedAlignmentPaths(alignment_1, alignment_2) == alignment_paths_10);
+    }
+
     SECTION("Incorrect oriented paired-end read alignment finds empty alignment path") {
 
         auto alignment_2_rc = Utils::lazy_reverse_complement_alignment(alignment_2, node_frag_length_func);
@@ -645,7 +723,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end alignment") {
         REQUIRE(paths_index_bd.bidirectional());
         REQUIRE(paths_index_bd.numberOfPaths() == 3);
 
-        AlignmentPathFinder<vg::Alignment> alignment_path_finder_bd(paths_index_bd, "unstranded", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::Alignment> alignment_path_finder_bd(paths_index_bd, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
     
         auto alignment_paths_bd = alignment_path_finder_bd.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_bd.size() == 3);
@@ -757,7 +835,7 @@ TEST_CASE("Circular alignment path(s) can be found from a paired-end alignment")
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 3);
 
-    AlignmentPathFinder<vg::Alignment> alignment_path_finder(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0);
+    AlignmentPathFinder<vg::Alignment> alignment_path_finder(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
 
     auto alignment_paths = alignment_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2);
     REQUIRE(alignment_paths.size() == 4);
@@ -1000,7 +1078,7 @@ TEST_CASE("Circular alignment path(s) can be found from a paired-end alignment")
         REQUIRE(paths_index_bd.bidirectional());
         REQUIRE(paths_index_bd.numberOfPaths() == 2);
 
-        AlignmentPathFinder<vg::Alignment> alignment_path_finder_bd(paths_index_bd, "unstranded", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::Alignment> alignment_path_finder_bd(paths_index_bd, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
     
         auto alignment_paths_bd = alignment_path_finder_bd.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_bd.size() == 3);
@@ -1170,7 +1248,7 @@ TEST_CASE("Alignment path(s) can be found from a single-end multipath alignment"
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 2);
 
-    AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0);
+    AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
     
     auto alignment_paths = alignment_path_finder.findAlignmentPaths(alignment_1);
     REQUIRE(alignment_paths.size() == 3);
@@ -1254,7 +1332,7 @@ TEST_CASE("Alignment path(s) can be found from a single-end multipath alignment"
         REQUIRE(paths_index_bd.bidirectional());
         REQUIRE(paths_index_bd.numberOfPaths() == 2);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bd(paths_index_bd, "unstranded", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bd(paths_index_bd, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
 
         auto alignment_paths_bd = alignment_path_finder_bd.findAlignmentPaths(alignment_1);
         REQUIRE(alignment_paths_bd.size() == 3);
@@ -1276,7 +1354,7 @@ TEST_CASE("Alignment path(s) can be found from a single-end multipath alignment"
 
     SECTION("Alignment pairs from a single-end multipath alignment does not estimate missing path noise probability") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_nm(paths_index, "unstranded", true, false, 1000, 0, false, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_nm(paths_index, 1, "unstranded", true, false, 1000, 0, false, 20, 0);
 
         auto alignment_paths_nm = alignment_path_finder_nm.findAlignmentPaths(alignment_1);
         REQUIRE(alignment_paths_nm.size() == 3);
@@ -1582,7 +1660,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 3);
 
-    AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0);
+    AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
 
     auto alignment_paths = alignment_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2);
     REQUIRE(alignment_paths.size() == 4);
@@ -1897,7 +1975,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
         REQUIRE(paths_index_bd.bidirectional());
         REQUIRE(paths_index_bd.numberOfPaths() == 2);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bd(paths_index_bd, "unstranded", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bd(paths_index_bd, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
     
         auto alignment_paths_bd = alignment_path_finder_bd.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_bd.size() == 3);
@@ -1914,7 +1992,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
 
     SECTION("Strand-specific paired-end multipath read alignment finds unidirectional alignment path(s)") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_fr(paths_index, "fr", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_fr(paths_index, 1, "fr", true, false, 1000, 0, true, 20, 0);
 
         auto alignment_paths_fr = alignment_path_finder_fr.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_fr.size() == 3);
@@ -1923,7 +2001,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
         REQUIRE(alignment_paths_fr.at(1) == alignment_paths.at(1));
         REQUIRE(alignment_paths_fr.back() == alignment_paths.back());
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_rf(paths_index, "rf", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_rf(paths_index, 1, "rf", true, false, 1000, 0, true, 20, 0);
 
         auto alignment_paths_rf = alignment_path_finder_rf.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_rf.size() == 2);
@@ -1943,7 +2021,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
 
     SECTION("Alignment pairs from a paired-end multipath alignment can use allelic mapping quality") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_fr(paths_index, "unstranded", true, true, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_fr(paths_index, 1, "unstranded", true, true, 1000, 0, true, 20, 0);
 
         auto alignment_paths_amq = alignment_path_finder_fr.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_amq.size() == 4);
@@ -1975,14 +2053,14 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
 
     SECTION("Alignment pairs from a paired-end multipath alignment are filtered based on length") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_len16(paths_index, "unstranded", true, false, 16, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_len16(paths_index, 1, "unstranded", true, false, 16, 0, true, 20, 0);
 
         auto alignment_paths_len16 = alignment_path_finder_len16.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_len16.size() == 4);
         
         REQUIRE(alignment_paths_len16 == alignment_paths);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_len12(paths_index, "unstranded", true, false, 12, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_len12(paths_index, 1, "unstranded", true, false, 12, 0, true, 20, 0);
 
         auto alignment_paths_len12 = alignment_path_finder_len12.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_len12.size() == 2);
@@ -1999,7 +2077,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
         REQUIRE(alignment_paths_len12.back().min_mapq == alignment_paths.back().min_mapq);
         REQUIRE(alignment_paths_len12.back().score_sum == alignment_paths.back().score_sum);
         
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_len11(paths_index, "unstranded", true, false, 11, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_len11(paths_index, 1, "unstranded", true, false, 11, 0, true, 20, 0);
 
         auto alignment_paths_len11 = alignment_path_finder_len11.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_len11.empty());
@@ -2007,14 +2085,14 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
 
     SECTION("Alignment pairs from a paired-end multipath alignment are filtered based on maximum score difference") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd7(paths_index, "unstranded", true, false, 1000, 0, true, 7, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd7(paths_index, 1, "unstranded", true, false, 1000, 0, true, 7, 0);
 
         auto alignment_paths_sd7 = alignment_path_finder_sd7.findPairedAlignmentPaths(alignment_1, alignment_2);    
         REQUIRE(alignment_paths_sd7.size() == 4);
 
         assert(alignment_paths_sd7 == alignment_paths);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd6(paths_index, "unstranded", true, false, 1000, 0, true, 6, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd6(paths_index, 1, "unstranded", true, false, 1000, 0, true, 6, 0);
 
         auto alignment_paths_sd6 = alignment_path_finder_sd6.findPairedAlignmentPaths(alignment_1, alignment_2);    
         REQUIRE(alignment_paths_sd6.size() == 3);
@@ -2037,7 +2115,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
         REQUIRE(alignment_paths_sd6.back().min_mapq == alignment_paths.back().min_mapq);
         REQUIRE(alignment_paths_sd6.back().score_sum == -48604);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd2(paths_index, "unstranded", true, false, 1000, 0, true, 2, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd2(paths_index, 1, "unstranded", true, false, 1000, 0, true, 2, 0);
 
         auto alignment_paths_sd2 = alignment_path_finder_sd2.findPairedAlignmentPaths(alignment_1, alignment_2);    
         REQUIRE(alignment_paths_sd2.size() == 3);
@@ -2060,7 +2138,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
         REQUIRE(alignment_paths_sd2.back().min_mapq == alignment_paths.back().min_mapq);
         REQUIRE(alignment_paths_sd2.back().score_sum == -48449);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd1(paths_index, "unstranded", true, false, 1000, 0, true, 1, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_sd1(paths_index, 1, "unstranded", true, false, 1000, 0, true, 1, 0);
 
         auto alignment_paths_sd1 = alignment_path_finder_sd1.findPairedAlignmentPaths(alignment_1, alignment_2);    
         REQUIRE(alignment_paths_sd1.empty());
@@ -2068,14 +2146,14 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
 
     SECTION("Alignment pairs from a paired-end multipath alignment are filtered based on best score fraction") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bs25(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0.25);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bs25(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0.25);
 
         auto alignment_paths_bs25 = alignment_path_finder_bs25.findPairedAlignmentPaths(alignment_1, alignment_2);    
         REQUIRE(alignment_paths_bs25.size() == 4);
 
         assert(alignment_paths_bs25 == alignment_paths);
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bs30(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0.30);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_bs30(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0.30);
 
         auto alignment_paths_bs30 = alignment_path_finder_bs30.findPairedAlignmentPaths(alignment_1, alignment_2);    
         REQUIRE(alignment_paths_bs30.size() == 4);
@@ -2093,7 +2171,7 @@ TEST_CASE("Alignment path(s) can be found from a paired-end multipath alignment"
 
     SECTION("Alignment pairs from a paired-end multipath alignment does not estimate missing path noise probability") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_nm(paths_index, "unstranded", true, false, 1000, 0, false, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_nm(paths_index, 1, "unstranded", true, false, 1000, 0, false, 20, 0);
 
         auto alignment_paths_nm = alignment_path_finder_nm.findPairedAlignmentPaths(alignment_1, alignment_2);
         REQUIRE(alignment_paths_nm.size() == 4);
@@ -2309,7 +2387,7 @@ TEST_CASE("Partial alignment path(s) can be found from a paired-end multipath al
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 3);
 
-    AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder(paths_index, "unstranded", true, false, 1000, 4, true, 20, 0);
+    AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder(paths_index, 1, "unstranded", true, false, 1000, 4, true, 20, 0);
 
     auto alignment_paths = alignment_path_finder.findPairedAlignmentPaths(alignment_1, alignment_2);
     REQUIRE(alignment_paths.size() == 10);
@@ -2389,7 +2467,7 @@ TEST_CASE("Partial alignment path(s) can be found from a paired-end multipath al
 
     SECTION("Partial alignment pairs from a paired-end multipath alignment are filtered based on maximum internal offset") {
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int3(paths_index, "unstranded", true, false, 1000, 3, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int3(paths_index, 1, "unstranded", true, false, 1000, 3, true, 20, 0);
 
         auto alignment_paths_int3 = alignment_path_finder_int3.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_int3.size() == 7);
@@ -2402,7 +2480,7 @@ TEST_CASE("Partial alignment path(s) can be found from a paired-end multipath al
         REQUIRE(alignment_paths_int3.at(5) == alignment_paths.at(5));
         REQUIRE(alignment_paths_int3.back() == alignment_paths.back());
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int2(paths_index, "unstranded", true, false, 1000, 2, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int2(paths_index, 1, "unstranded", true, false, 1000, 2, true, 20, 0);
 
         auto alignment_paths_int2 = alignment_path_finder_int2.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_int2.size() == 4);
@@ -2412,7 +2490,7 @@ TEST_CASE("Partial alignment path(s) can be found from a paired-end multipath al
         REQUIRE(alignment_paths_int2.at(2) == alignment_paths.at(5));
         REQUIRE(alignment_paths_int2.back() == alignment_paths.back());
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int1(paths_index, "unstranded", true, false, 1000, 1, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int1(paths_index, 1, "unstranded", true, false, 1000, 1, true, 20, 0);
 
         auto alignment_paths_int1 = alignment_path_finder_int1.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_int1.size() == 2);
@@ -2420,7 +2498,7 @@ TEST_CASE("Partial alignment path(s) can be found from a paired-end multipath al
         REQUIRE(alignment_paths_int1.front() == alignment_paths.at(5));
         REQUIRE(alignment_paths_int1.back() == alignment_paths.back());
 
-        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int0(paths_index, "unstranded", true, false, 1000, 0, true, 20, 0);
+        AlignmentPathFinder<vg::MultipathAlignment> alignment_path_finder_int0(paths_index, 1, "unstranded", true, false, 1000, 0, true, 20, 0);
 
         auto alignment_paths_int0 = alignment_path_finder_int0.findPairedAlignmentPaths(alignment_1, alignment_2);        
         REQUIRE(alignment_paths_int0.empty());        
@@ -0,0 +1,172 @@
+
+#include "catch.hpp"
+
+#include "gbwt/dynamic_gbwt.h"
+#include "gbwt/fast_locate.h"
+#include "sparsepp/spp.h"
+
+#include "../alignment_paths_cache.hpp"
+#include "../utils.hpp"
+
+
+TEST_CASE("Alignment path index can be written to and loaded from a cache") {
+
+	gbwt::Verbosity::set(gbwt::Verbosity::SILENT);
+    gbwt::GBWTBuilder gbwt_builder(gbwt::bit_length(gbwt::Node::encode(4, true)));
+
+    gbwt::vector_type gbwt_thread_1(3);
+    gbwt::vector_type gbwt_thread_2(3);
+
+    gbwt_thread_1[0] = gbwt::Node::encode(1, false);
+    gbwt_thread_1[1] = gbwt::Node::encode(2, false);
+    gbwt_thread_1[2] = gbwt::Node::encode(4, false);
+
+    gbwt_thread_2[0] = gbwt::Node::encode(1, false);
+    gbwt_thread_2[1] = gbwt::Node::encode(3, false);
+    gbwt_thread_2[2] = gbwt::Node::encode(4, false);
+
+    gbwt_builder.insert(gbwt_thread_1, false);
+    gbwt_builder.insert(gbwt_thread_2, false);
+
+    gbwt_builder.index.addMetadata();
+
+    for (uint32_t i = 0; i < 2; ++i) {
+
+    	gbwt_builder.index.metadata.addPath(gbwt::PathName());
+    }
+
+    gbwt_builder.finish();
+
+    std::stringstream gbwt_stream;
+    gbwt_builder.index.serialize(gbwt_stream);
+
+    gbwt::GBWT gbwt_index;
+    gbwt_index.load(gbwt_stream);
+
+    const string graph_str = R"(
+    	{
+    		"node": [
+    			{"id": 1, "sequence": "A"},
+    			{"id": 2, "sequence": "A"},
+    			{"id": 3, "sequence": "A"},
+    			{"id": 4, "sequence": "A"}
+    		],
+    	}
+    )";
+
+	vg::Graph graph;
+	Utils::json2pb(graph, graph_str);
+
+    gbwt::FastLocate r_index(gbwt_index);
+    PathsIndex paths_index(gbwt_index, r_index, graph);
+
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search_1;
+    paths_index.find(&gbwt_search_1, gbwt::Node::encode(1, false));
+
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search_2 = gbwt_search_1;
+    paths_index.extend(&gbwt_search_2, gbwt::Node::encode(2, false));
+
+    REQUIRE(gbwt_search_1.first.size() == 2);
+    REQUIRE(gbwt_search_2.first.size() == 1);
+
+    AlignmentPathsIndex align_paths_index;
+
+    align_paths_index.add(vector<AlignmentPath>({AlignmentPath(gbwt_search_1, true, 60, 10, 20, 0), AlignmentPath(gbwt_search_1, false, 0, 0, 0, 0)}), 3);
+    align_paths_index.add(vector<AlignmentPath>({AlignmentPath(gbwt_search_2, false, 42, -5, 150, 300), AlignmentPath(gbwt_search_1, true, 0, 0, 0, 0)}), 1);
+
+    FragmentLengthDist frag_length_dist(300, 20, 10);
+    REQUIRE(frag_length_dist.isValid());
+
+    AlignmentPathsCache align_paths_cache(paths_index, false, false, "unstranded", false, false, false, 0, 24, 0.9, frag_length_dist);
+
+    std::stringstream cache_stream;
+    align_paths_cache.serialize(cache_stream, align_paths_index, frag_length_dist, 7);
+
+    AlignmentPathsIndex loaded_align_paths_index;
+    FragmentLengthDist loaded_frag_length_dist;
+    uint32_t loaded_unaligned_read_count = 0;
+
+    REQUIRE(align_paths_cache.load(cache_stream, &loaded_align_paths_index, &loaded_frag_length_dist, &loaded_unaligned_read_count));
+
+    REQUIRE(loaded_align_paths_index.size() == align_paths_index.size());
+
+    for (auto & align_paths: align_paths_index) {
+
+        auto loaded_align_paths_it = loaded_align_paths_index.find(align_paths.first);
+
+        REQUIRE(loaded_align_paths_it != loaded_align_paths_index.end());
+        REQUIRE(loaded_align_paths_it->first == align_paths.first);
+        REQUIRE(loaded_align_paths_it->second == align_paths.second);
+    }
+
+    REQUIRE(loaded_unaligned_read_count == 7);
+
+    REQUIRE(loaded_frag_length_dist.loc() == Approx(frag_length_dist.loc()));
+    REQUIRE(loaded_frag_length_dist.scale() == Approx(frag_length_dist.scale()));
+    REQUIRE(loaded_frag_length_dist.maxLength() == frag_length_dist.maxLength());
+
+    SECTION("Cache is rejected for different read types") {
+
+        AlignmentPathsCache align_paths_cache_se(paths_index, true, false, "unstranded", false, false, false, 0, 24, 0.9, frag_length_dist);
+
+        std::stringstream cache_stream_se;
+        align_paths_cache.serialize(cache_stream_se, align_paths_index, frag_length_dist, 7);
+
+        AlignmentPathsIndex align_paths_index_se;
+        FragmentLengthDist frag_length_dist_se;
+        uint32_t unaligned_read_count_se = 0;
+
+        REQUIRE(!align_paths_cache_se.load(cache_stream_se, &align_paths_index_se, &frag_length_dist_se, &unaligned_read_count_se));
+    }
+
+    SECTION("Cache is rejected for different alignment path options") {
+
+        AlignmentPathsCache align_paths_cache_diff(paths_index, false, false, "unstranded", false, false, false, 0, 12, 0.9, frag_length_dist);
+
+        std::stringstream cache_stream_diff;
+        align_paths_cache.serialize(cache_stream_diff, align_paths_index, frag_length_dist, 7);
+
+        AlignmentPathsIndex align_paths_index_diff;
+        FragmentLengthDist frag_length_dist_diff;
+        uint32_t unaligned_read_count_diff = 0;
+
+        REQUIRE(!align_paths_cache_diff.load(cache_stream_diff, &align_paths_index_diff, &frag_length_dist_diff, &unaligned_read_count_diff));
+    }
+
+    SECTION("Cache is rejected for different fragment length distribution parameters") {
+
+        AlignmentPathsCache align_paths_cache_frag(paths_index, false, false, "unstranded", false, false, false, 0, 24, 0.9, FragmentLengthDist(250, 20, 10));
+
+        std::stringstream cache_stream_frag;
+        align_paths_cache.serialize(cache_stream_frag, align_paths_index, frag_length_dist, 7);
+
+        AlignmentPathsIndex align_paths_index_frag;
+        FragmentLengthDist frag_length_dist_frag;
+        uint32_t unaligned_read_count_frag = 0;
+
+        REQUIRE(!align_paths_cache_frag.load(cache_stream_frag, &align_paths_index_frag, &frag_length_dist_frag, &unaligned_read_count_frag));
+
+        SECTION("Cache is loaded without fragment length distribution parameters") {
+
+            AlignmentPathsCache align_paths_cache_nofrag(paths_index, false, false, "unstranded", false, false, false, 0, 24, 0.9, FragmentLengthDist());
+
+            std::stringstream cache_stream_nofrag;
+            align_paths_cache.serialize(cache_stream_nofrag, align_paths_index, frag_length_dist, 7);
+
+            REQUIRE(align_paths_cache_nofrag.load(cache_stream_nofrag, &align_paths_index_frag, &frag_length_dist_frag, &unaligned_read_count_frag));
+            REQUIRE(align_paths_index_frag.size() == align_paths_index.size());
+        }
+    }
+
+    SECTION("Truncated cache is rejected") {
+
+        const string cache_str = cache_stream.str();
+        std::stringstream truncated_cache_stream(cache_str.substr(0, cache_str.size() - 1));
+
+        AlignmentPathsIndex truncated_align_paths_index;
+        FragmentLengthDist truncated_frag_length_dist;
+        uint32_t truncated_unaligned_read_count = 0;
+
+        REQUIRE(!align_paths_cache.load(truncated_cache_stream, &truncated_align_paths_index, &truncated_frag_length_dist, &truncated_unaligned_read_count));
+    }
+}
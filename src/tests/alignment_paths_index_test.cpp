@@ -0,0 +1,69 @@
+
+#include "catch.hpp"
+
+#include "../alignment_paths_index.hpp"
+
+
+TEST_CASE("Alignment paths index counts unique alignment paths") {
+
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search_1(gbwt::SearchState(gbwt::Node::encode(1, false), 0, 1), 1);
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search_2(gbwt::SearchState(gbwt::Node::encode(2, false), 0, 0), 1);
+
+    vector<AlignmentPath> align_paths_1({AlignmentPath(gbwt_search_1, true, 60, 10, 20, 100), AlignmentPath(pair<gbwt::SearchState, gbwt::size_type>(), false, 60, 0, 0, 0)});
+    vector<AlignmentPath> align_paths_2({AlignmentPath(gbwt_search_2, true, 60, 10, 20, 100), AlignmentPath(pair<gbwt::SearchState, gbwt::size_type>(), false, 60, 0, 0, 0)});
+
+    AlignmentPathsIndex align_paths_index;
+
+    REQUIRE(align_paths_index.add(align_paths_1, 1));
+    REQUIRE(!align_paths_index.add(align_paths_1, 2));
+    REQUIRE(align_paths_index.add(align_paths_2, 1));
+
+    REQUIRE(align_paths_index.size() == 2);
+
+    auto align_paths_index_it = align_paths_index.find(align_paths_1);
+    
+    REQUIRE(align_paths_index_it != align_paths_index.end());
+    REQUIRE(align_paths_index_it->first == AlignmentPathSpan(align_paths_1));
+    REQUIRE(align_paths_index_it->first.begin() != align_paths_1.data());
+    REQUIRE(align_paths_index_it->second == 3);
+
+    align_paths_1.front().score_sum = 1;
+    REQUIRE(align_paths_index.find(align_paths_1) == align_paths_index.end());
+
+    SECTION("Alignment paths index iterators can be accessed randomly") {
+
+        auto align_paths_index_its = align_paths_index.iterators();
+        REQUIRE(align_paths_index_its.size() == 2);
+
+        auto align_paths_index_iter_it = align_paths_index.begin();
+
+        for (auto & index_it: align_paths_index_its) {
+
+            REQUIRE(index_it == align_paths_index_iter_it);
+            ++align_paths_index_iter_it;
+        }
+
+        REQUIRE(align_paths_index_iter_it == align_paths_index.end());
+    }
+
+    SECTION("Alignment paths indexes can be merged") {
+
+        vector<AlignmentPath> align_paths_3({AlignmentPath(gbwt_search_1, false, 10, 2, 20, 100), AlignmentPath(gbwt_search_2, false, 10, 2, 20, 120), AlignmentPath(pair<gbwt::SearchState, gbwt::size_type>(), false, 10, 0, 0, 0)});
+
+        AlignmentPathsIndex align_paths_index_2;
+        REQUIRE(align_paths_index_2.add(align_paths_3, 4));
+
+        const AlignmentPath * align_paths_3_arena = align_paths_index_2.find(align_paths_3)->first.begin();
+        align_paths_index.merge(&align_paths_index_2);
+
+        REQUIRE(align_paths_index_2.empty());
+        REQUIRE(align_paths_index.size() == 3);
+
+        auto align_paths_index_merge_it = align_paths_index.find(align_paths_3);
+
+        REQUIRE(align_paths_index_merge_it != align_paths_index.end());
+        REQUIRE(align_paths_index_merge_it->first.begin() == align_paths_3_arena);
+        REQUIRE(align_paths_index_merge_it->first.size() == 3);
+        REQUIRE(align_paths_index_merge_it->second == 4);
+    }
+}
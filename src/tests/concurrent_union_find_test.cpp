@@ -0,0 +1,48 @@
+
+#include "catch.hpp"
+
+#include "../concurrent_union_find.hpp"
+
+
+TEST_CASE("Union-find sets can be united") {
+
+    ConcurrentUnionFind union_find(6);
+    REQUIRE(union_find.size() == 6);
+
+    for (uint32_t i = 0; i < union_find.size(); ++i) {
+
+        REQUIRE(union_find.find(i) == i);
+    }
+
+    union_find.unite(0, 3);
+    union_find.unite(4, 3);
+    union_find.unite(1, 5);
+    union_find.unite(5, 1);
+
+    REQUIRE(union_find.find(0) == union_find.find(3));
+    REQUIRE(union_find.find(0) == union_find.find(4));
+    REQUIRE(union_find.find(1) == union_find.find(5));
+
+    REQUIRE(union_find.find(0) != union_find.find(1));
+    REQUIRE(union_find.find(0) != union_find.find(2));
+    REQUIRE(union_find.find(1) != union_find.find(2));
+    REQUIRE(union_find.find(2) == 2);
+
+    SECTION("Union-find sets can be united in parallel") {
+
+        ConcurrentUnionFind parallel_union_find(10000);
+
+        #pragma omp parallel for num_threads(4) schedule(static, 1)
+        for (uint32_t i = 2; i < parallel_union_find.size(); ++i) {
+
+            parallel_union_find.unite(i, i - 2);
+        }
+
+        for (uint32_t i = 2; i < parallel_union_find.size(); ++i) {
+
+            REQUIRE(parallel_union_find.find(i) == parallel_union_find.find(i % 2));
+        }
+
+        REQUIRE(parallel_union_find.find(0) != parallel_union_find.find(1));
+    }
+}
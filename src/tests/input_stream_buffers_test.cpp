@@ -0,0 +1,162 @@
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <stdio.h>
+
+#include "htslib/bgzf.h"
+
+#include "../input_stream_buffers.hpp"
+
+
+TEST_CASE("Rewindable input buffer replays recorded input") {
+
+    const string input_str = "ACGTACGTAC";
+
+    std::stringstream source_stream(input_str);
+    RewindableInputBuffer rewindable_buffer(source_stream.rdbuf(), 1024);
+
+    istream rewindable_stream(&rewindable_buffer);
+    REQUIRE(rewindable_buffer.isRecording());
+
+    string prefix(4, ' ');
+    rewindable_stream.read(&prefix.front(), prefix.size());
+    
+    REQUIRE(prefix == "ACGT");
+
+    rewindable_buffer.rewind();
+    REQUIRE(!rewindable_buffer.isRecording());
+
+    std::stringstream output_stream;
+    output_stream << rewindable_stream.rdbuf();
+
+    REQUIRE(output_stream.str() == input_str);
+
+    SECTION("Rewinding after reading to end of input replays everything") {
+
+        std::stringstream source_stream_end(input_str);
+        RewindableInputBuffer rewindable_buffer_end(source_stream_end.rdbuf(), 1024);
+
+        istream rewindable_stream_end(&rewindable_buffer_end);
+
+        std::stringstream output_stream_end_1;
+        output_stream_end_1 << rewindable_stream_end.rdbuf();
+
+        REQUIRE(output_stream_end_1.str() == input_str);
+
+        rewindable_buffer_end.rewind();
+        rewindable_stream_end.clear();
+
+        std::stringstream output_stream_end_2;
+        output_stream_end_2 << rewindable_stream_end.rdbuf();
+
+        REQUIRE(output_stream_end_2.str() == input_str);
+    }
+
+    SECTION("Rewinding without reading passes input through") {
+
+        std::stringstream source_stream_empty(input_str);
+        RewindableInputBuffer rewindable_buffer_empty(source_stream_empty.rdbuf(), 1024);
+
+        rewindable_buffer_empty.rewind();
+        istream rewindable_stream_empty(&rewindable_buffer_empty);
+
+        std::stringstream output_stream_empty;
+        output_stream_empty << rewindable_stream_empty.rdbuf();
+
+        REQUIRE(output_stream_empty.str() == input_str);
+    }
+
+    SECTION("Recording stops at limit") {
+
+        std::stringstream source_stream_limit(input_str);
+        RewindableInputBuffer rewindable_buffer_limit(source_stream_limit.rdbuf(), 6);
+
+        istream rewindable_stream_limit(&rewindable_buffer_limit);
+
+        std::stringstream output_stream_limit_1;
+        output_stream_limit_1 << rewindable_stream_limit.rdbuf();
+
+        REQUIRE(output_stream_limit_1.str() == "ACGTAC");
+        REQUIRE(rewindable_buffer_limit.recordingLimitReached());
+
+        rewindable_buffer_limit.rewind();
+        rewindable_stream_limit.clear();
+
+        std::stringstream output_stream_limit_2;
+        output_stream_limit_2 << rewindable_stream_limit.rdbuf();
+
+        REQUIRE(output_stream_limit_2.str() == input_str);
+    }
+}
+
+TEST_CASE("BGZF input buffer reads compressed and uncompressed input") {
+
+    string input_str;
+    input_str.reserve(200000);
+
+    for (uint32_t i = 0; i < 200000; ++i) {
+
+        input_str.push_back("ACGTN\n"[(i * 7 + i / 13) % 6]);
+    }
+
+    const string compressed_filename = "input_stream_buffers_test.gz";
+    const string uncompressed_filename = "input_stream_buffers_test.txt";
+
+    BGZF * compressed_file = bgzf_open(compressed_filename.c_str(), "w");
+    REQUIRE(compressed_file);
+
+    const ssize_t num_compressed_bytes = bgzf_write(compressed_file, input_str.data(), input_str.size());
+    REQUIRE(num_compressed_bytes == static_cast<ssize_t>(input_str.size()));
+
+    const int compressed_status = bgzf_close(compressed_file);
+    REQUIRE(compressed_status == 0);
+
+    BGZF * uncompressed_file = bgzf_open(uncompressed_filename.c_str(), "wu");
+    REQUIRE(uncompressed_file);
+
+    const ssize_t num_uncompressed_bytes = bgzf_write(uncompressed_file, input_str.data(), input_str.size());
+    REQUIRE(num_uncompressed_bytes == static_cast<ssize_t>(input_str.size()));
+
+    const int uncompressed_status = bgzf_close(uncompressed_file);
+    REQUIRE(uncompressed_status == 0);
+
+    for (uint32_t num_threads = 1; num_threads <= 2; ++num_threads) {
+
+        BgzfInputBuffer compressed_buffer(compressed_filename, num_threads);
+        REQUIRE(compressed_buffer.isOpen());
+        REQUIRE(compressed_buffer.isCompressed());
+
+        istream compressed_stream(&compressed_buffer);
+
+        std::stringstream compressed_output_stream;
+        compressed_output_stream << compressed_stream.rdbuf();
+
+        REQUIRE(compressed_output_stream.str() == input_str);
+        REQUIRE(compressed_buffer.decompressedBytes() == input_str.size());
+        REQUIRE(compressed_buffer.numFills() > 1);
+
+        BgzfInputBuffer uncompressed_buffer(uncompressed_filename, num_threads);
+        REQUIRE(uncompressed_buffer.isOpen());
+        REQUIRE(!uncompressed_buffer.isCompressed());
+
+        istream uncompressed_stream(&uncompressed_buffer);
+
+        std::stringstream uncompressed_output_stream;
+        uncompressed_output_stream << uncompressed_stream.rdbuf();
+
+        REQUIRE(uncompressed_output_stream.str() == input_str);
+        REQUIRE(uncompressed_buffer.decompressedBytes() == input_str.size());
+        REQUIRE(uncompressed_buffer.numFills() > 1);
+    }
+
+    SECTION("Missing file is not opened") {
+
+        BgzfInputBuffer missing_buffer("input_stream_buffers_test_missing.gz", 1);
+        REQUIRE(!missing_buffer.isOpen());
+    }
+
+    remove(compressed_filename.c_str());
+    remove(uncompressed_filename.c_str());
+}
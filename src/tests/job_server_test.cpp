@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "../job_server.hpp"
+
+
+// Returns an empty reply if the job could not be sent. Catch assertions 
+// are not used since jobs are also sent from multiple threads.
+string sendJob(const string & socket_filename, const string & job_line) {
+
+    const int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (socket_fd < 0) {
+
+        return "";
+    }
+
+    sockaddr_un socket_address;
+    memset(&socket_address, 0, sizeof(socket_address));
+
+    socket_address.sun_family = AF_UNIX;
+    strncpy(socket_address.sun_path, socket_filename.c_str(), sizeof(socket_address.sun_path) - 1);
+
+    const string job_line_newline = job_line + "\n";
+
+    if (connect(socket_fd, reinterpret_cast<sockaddr *>(&socket_address), sizeof(socket_address)) != 0 || write(socket_fd, job_line_newline.data(), job_line_newline.size()) != static_cast<ssize_t>(job_line_newline.size())) {
+
+        close(socket_fd);
+        return "";
+    }
+
+    string reply;
+    char cur_char = 0;
+
+    while (read(socket_fd, &cur_char, 1) == 1 && cur_char != '\n') {
+
+        reply += cur_char;
+    }
+
+    close(socket_fd);
+    return reply;
+}
+
+TEST_CASE("Job server runs jobs received on socket") {
+
+    const string socket_filename = "job_server_test.sock";
+
+    JobServer job_server(socket_filename, 1);
+    REQUIRE(job_server.isOpen());
+
+    struct stat socket_stat;
+    REQUIRE(stat(socket_filename.c_str(), &socket_stat) == 0);
+    REQUIRE((socket_stat.st_mode & 0777) == 0600);
+
+    vector<uint64_t> received_job_ids;
+    vector<vector<string> > received_job_args;
+
+    thread server_thread([&]() {
+
+        job_server.run([&](const uint64_t job_id, const vector<string> & job_args) { 
+
+            received_job_ids.emplace_back(job_id);
+            received_job_args.emplace_back(job_args);
+
+            return static_cast<int>(job_args.size()); 
+        });
+    });
+
+    REQUIRE(sendJob(socket_filename, "-a reads.gamp  -o sample1") == "4");
+    REQUIRE(sendJob(socket_filename, "") == "0");
+    REQUIRE(sendJob(socket_filename, "shutdown") == "0");
+
+    server_thread.join();
+
+    REQUIRE(received_job_ids == vector<uint64_t>({1, 2}));
+
+    REQUIRE(received_job_args.size() == 2);
+    REQUIRE(received_job_args.front() == vector<string>({"-a", "reads.gamp", "-o", "sample1"}));
+    REQUIRE(received_job_args.back().empty());
+
+    SECTION("Job server limits number of concurrent jobs") {
+
+        JobServer job_server_limit(socket_filename, 2);
+        REQUIRE(job_server_limit.isOpen());
+
+        atomic<uint32_t> num_running_jobs(0);
+        atomic<uint32_t> max_num_running_jobs(0);
+
+        thread server_limit_thread([&]() {
+
+            job_server_limit.run([&](const uint64_t job_id, const vector<string> & job_args) { 
+
+                const uint32_t cur_num_running_jobs = ++num_running_jobs;
+                uint32_t cur_max_num_running_jobs = max_num_running_jobs;
+
+                while (cur_num_running_jobs > cur_max_num_running_jobs && !max_num_running_jobs.compare_exchange_weak(cur_max_num_running_jobs, cur_num_running_jobs)) {}
+
+                this_thread::sleep_for(chrono::milliseconds(50));
+                --num_running_jobs;
+
+                return 0; 
+            });
+        });
+
+        vector<thread> client_threads;
+        vector<string> replies(6);
+
+        for (size_t i = 0; i < replies.size(); ++i) {
+
+            client_threads.emplace_back([&, i]() { replies.at(i) = sendJob(socket_filename, "-o sample"); });
+        }
+
+        for (auto & client_thread: client_threads) {
+
+            client_thread.join();
+        }
+
+        REQUIRE(sendJob(socket_filename, "shutdown") == "0");
+        server_limit_thread.join();
+
+        REQUIRE(replies == vector<string>(6, "0"));
+        REQUIRE(max_num_running_jobs <= 2);
+    }
+}
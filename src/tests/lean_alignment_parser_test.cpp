@@ -0,0 +1,154 @@
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <algorithm>
+
+#include "vg/io/message_emitter.hpp"
+#include "io/register_libvg_io.hpp"
+
+#include "../lean_alignment_parser.hpp"
+#include "../utils.hpp"
+
+
+TEST_CASE("Unused alignment fields and annotation keys can be filtered") {
+
+    const string alignment_str = R"(
+        {
+            "sequence": "CAAATAAGGCTTGGAAATTTTCTGGAGTTCTA",
+            "quality": "ERERERERERERERERERERERERERERERER",
+            "name": "read1",
+            "subpath": [
+                {"path": {"mapping": [{"position": {"node_id": 1, "offset": 2}, "edit": [{"from_length": 32, "to_length": 32}]}]}, "score": 42}
+            ],
+            "mapping_quality": 60,
+            "start": [0],
+            "annotation": {"allelic_mapq": 5, "disconnected": true, "fragment_length_distribution": "-I 10 -D 2"}
+        }
+    )";
+
+    vg::MultipathAlignment alignment;
+    Utils::json2pb(alignment, alignment_str);
+
+    string message;
+    alignment.SerializeToString(&message);
+
+    LeanMessageFilter message_filter(vg::MultipathAlignment::descriptor(), vector<string>({"sequence", "quality", "path", "subpath", "start", "mapping_quality", "score", "annotation"}), vector<string>({"allelic_mapq", "disconnected"}));
+
+    string filtered_message;
+    message_filter.filter(message, &filtered_message);
+
+    REQUIRE(filtered_message.size() < message.size());
+
+    vg::MultipathAlignment filtered_alignment;
+    REQUIRE(filtered_alignment.ParseFromString(filtered_message));
+
+    REQUIRE(filtered_alignment.name().empty());
+
+    REQUIRE(filtered_alignment.sequence() == alignment.sequence());
+    REQUIRE(filtered_alignment.quality() == alignment.quality());
+    REQUIRE(filtered_alignment.mapping_quality() == 60);
+    REQUIRE(filtered_alignment.start_size() == 1);
+
+    REQUIRE(filtered_alignment.subpath_size() == 1);
+    REQUIRE(filtered_alignment.subpath(0).score() == 42);
+    REQUIRE(filtered_alignment.subpath(0).path().mapping(0).position().offset() == 2);
+
+    REQUIRE(filtered_alignment.annotation().fields().size() == 2);
+    REQUIRE(filtered_alignment.annotation().fields().at("allelic_mapq").number_value() == 5);
+    REQUIRE(filtered_alignment.annotation().fields().at("disconnected").bool_value());
+    REQUIRE(filtered_alignment.annotation().fields().count("fragment_length_distribution") == 0);
+
+    SECTION("Alignments without annotation can be filtered") {
+
+        alignment.clear_annotation();
+        alignment.SerializeToString(&message);
+
+        message_filter.filter(message, &filtered_message);
+        REQUIRE(filtered_alignment.ParseFromString(filtered_message));
+
+        REQUIRE(!filtered_alignment.has_annotation());
+        REQUIRE(filtered_alignment.sequence() == alignment.sequence());
+    }
+}
+
+TEST_CASE("Serialized messages can be processed in parallel batches") {
+
+    stringstream messages_stream;
+
+    {
+        vg::io::MessageEmitter message_emitter(messages_stream);
+
+        for (uint32_t i = 0; i < 5; ++i) {
+
+            message_emitter.write_copy("GAM", "message" + to_string(i));
+        }
+
+        message_emitter.write_copy("TEST", "skipped");
+    }
+
+    vector<vector<string> > batches;
+
+    forEachMessageBatchParallel(messages_stream, 2, [](const string & tag) { return tag == "GAM"; }, [&](const vector<string> & batch) {
+
+        #pragma omp critical
+        {
+            batches.emplace_back(batch);
+        }
+    });
+
+    sort(batches.begin(), batches.end());
+
+    REQUIRE(batches.size() == 3);
+    REQUIRE(batches.at(0) == vector<string>({"message0", "message1"}));
+    REQUIRE(batches.at(1) == vector<string>({"message2", "message3"}));
+    REQUIRE(batches.at(2) == vector<string>({"message4"}));
+
+    SECTION("Errors while processing a batch are thrown after all batches have been processed") {
+
+        messages_stream.clear();
+        messages_stream.seekg(0);
+
+        REQUIRE_THROWS_AS(forEachMessageBatchParallel(messages_stream, 2, [](const string & tag) { return tag == "GAM"; }, [&](const vector<string> & batch) {
+
+            if (batch.size() % 2 != 0) {
+
+                throw runtime_error("Unpaired message");
+            }
+        }), runtime_error);
+    }
+}
+
+TEST_CASE("Interleaved alignments ending with an unpaired alignment are rejected") {
+
+    REQUIRE(vg::io::register_libvg_io());
+
+    vg::Alignment alignment;
+    alignment.set_sequence("CAAATAAGGCTTGGAAATTTTCTGGAGTTCTA");
+
+    string message;
+    alignment.SerializeToString(&message);
+
+    stringstream alignments_stream;
+
+    {
+        vg::io::MessageEmitter message_emitter(alignments_stream);
+
+        for (uint32_t i = 0; i < 3; ++i) {
+
+            message_emitter.write_copy("GAM", message);
+        }
+    }
+
+    LeanMessageFilter message_filter(vg::Alignment::descriptor(), vector<string>({"sequence"}), vector<string>());
+
+    uint32_t num_pairs = 0;
+
+    REQUIRE_THROWS_AS(forEachLeanInterleavedPairParallel<vg::Alignment>(alignments_stream, message_filter, [&](const vg::Alignment & alignment_1, const vg::Alignment & alignment_2) {
+
+        #pragma omp atomic
+        num_pairs++;
+    }), runtime_error);
+
+    REQUIRE(num_pairs == 0);
+}
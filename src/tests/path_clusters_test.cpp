@@ -74,9 +74,10 @@ TEST_CASE("GBWT paths can be clustered") {
     REQUIRE(!paths_index.bidirectional());
     REQUIRE(paths_index.numberOfPaths() == 4);
 
-    spp::sparse_hash_map<vector<AlignmentPath>, uint32_t> align_paths_index;
+    AlignmentPathsIndex align_paths_index;
+    PathIdsIndex path_ids_index;
 
-    PathClusters path_clusters(1, paths_index, align_paths_index);
+    PathClusters path_clusters(1, paths_index, path_ids_index, align_paths_index);
     path_clusters.addNodeClusters(paths_index);
 
     REQUIRE(path_clusters.path_to_cluster_index.size() == 4);
@@ -86,6 +87,58 @@ TEST_CASE("GBWT paths can be clustered") {
     REQUIRE(path_clusters.cluster_to_paths_index.at(1) == vector<uint32_t>({1, 3}));
     REQUIRE(path_clusters.cluster_to_paths_index.at(2) == vector<uint32_t>({2}));
 
+    SECTION("GBWT paths can be clustered by alignment paths") {
+
+        pair<gbwt::SearchState, gbwt::size_type> gbwt_search_1;
+        paths_index.find(&gbwt_search_1, gbwt::Node::encode(1, false));
+
+        pair<gbwt::SearchState, gbwt::size_type> gbwt_search_2;
+        paths_index.find(&gbwt_search_2, gbwt::Node::encode(3, false));
+
+        vector<AlignmentPath> align_paths({AlignmentPath(gbwt_search_1, true, 60, 10, 20, 100), AlignmentPath(gbwt_search_2, true, 60, 10, 20, 100), AlignmentPath(pair<gbwt::SearchState, gbwt::size_type>(), false, 60, 0, 0, 0)});
+
+        AlignmentPathsIndex align_paths_index_2;
+        align_paths_index_2.add(align_paths, 1);
+
+        PathIdsIndex path_ids_index_2;
+        path_ids_index_2.addAlignmentPaths(paths_index, align_paths_index_2, 2);
+
+        PathClusters path_clusters_2(2, paths_index, path_ids_index_2, align_paths_index_2);
+
+        REQUIRE(path_clusters_2.path_to_cluster_index == vector<uint32_t>({0, 1, 0, 2}));
+        REQUIRE(path_clusters_2.cluster_to_paths_index.size() == 3);
+        REQUIRE(path_clusters_2.cluster_to_paths_index.at(0) == vector<uint32_t>({0, 2}));
+        REQUIRE(path_clusters_2.cluster_to_paths_index.at(1) == vector<uint32_t>({1}));
+        REQUIRE(path_clusters_2.cluster_to_paths_index.at(2) == vector<uint32_t>({3}));
+    }
+
+    SECTION("Clusters of GBWT paths sharing a node can be serialized and loaded") {
+
+        PathsIndex paths_index_build(gbwt_index, r_index, graph);
+        REQUIRE(!paths_index_build.hasNodePathClusters());
+
+        paths_index_build.buildNodePathClusters(1);
+        REQUIRE(paths_index_build.hasNodePathClusters());
+
+        std::stringstream node_path_clusters_stream;
+        paths_index_build.serializeNodePathClusters(node_path_clusters_stream);
+
+        PathsIndex paths_index_load(gbwt_index, r_index, graph);
+        REQUIRE(paths_index_load.loadNodePathClusters(node_path_clusters_stream));
+
+        REQUIRE(paths_index_load.hasNodePathClusters());
+        REQUIRE(paths_index_load.nodePathCluster(0) == 0);
+        REQUIRE(paths_index_load.nodePathCluster(1) == 1);
+        REQUIRE(paths_index_load.nodePathCluster(2) == 2);
+        REQUIRE(paths_index_load.nodePathCluster(3) == 1);
+
+        PathClusters path_clusters_load(1, paths_index_load, path_ids_index, align_paths_index);
+        path_clusters_load.addNodeClusters(paths_index_load);
+
+        REQUIRE(path_clusters_load.path_to_cluster_index == path_clusters.path_to_cluster_index);
+        REQUIRE(path_clusters_load.cluster_to_paths_index == path_clusters.cluster_to_paths_index);
+    }
+
     SECTION("Bidirectionality affect clustering") {
 
     	gbwt::Verbosity::set(gbwt::Verbosity::SILENT);
@@ -0,0 +1,93 @@
+
+#include "catch.hpp"
+
+#include "gbwt/dynamic_gbwt.h"
+#include "gbwt/fast_locate.h"
+
+#include "../path_ids_index.hpp"
+#include "../utils.hpp"
+
+
+TEST_CASE("Path ids of unique GBWT searches can be indexed") {
+
+    gbwt::Verbosity::set(gbwt::Verbosity::SILENT);
+    gbwt::GBWTBuilder gbwt_builder(gbwt::bit_length(gbwt::Node::encode(3, true)));
+
+    gbwt::vector_type gbwt_thread_1(2);
+    gbwt::vector_type gbwt_thread_2(2);
+    gbwt::vector_type gbwt_thread_3(1);
+
+    gbwt_thread_1[0] = gbwt::Node::encode(1, false);
+    gbwt_thread_1[1] = gbwt::Node::encode(2, false);
+
+    gbwt_thread_2[0] = gbwt::Node::encode(3, false);
+    gbwt_thread_2[1] = gbwt::Node::encode(2, false);
+
+    gbwt_thread_3[0] = gbwt::Node::encode(1, false);
+
+    gbwt_builder.insert(gbwt_thread_1, false);
+    gbwt_builder.insert(gbwt_thread_2, false);
+    gbwt_builder.insert(gbwt_thread_3, false);
+
+    gbwt_builder.finish();
+
+    std::stringstream gbwt_stream;
+    gbwt_builder.index.serialize(gbwt_stream);
+
+    gbwt::GBWT gbwt_index;
+    gbwt_index.load(gbwt_stream);
+
+    const string graph_str = R"(
+        {
+            "node": [
+                {"id": 1, "sequence": "A"},
+                {"id": 2, "sequence": "A"},
+                {"id": 3, "sequence": "A"}
+            ],
+        }
+    )";
+
+    vg::Graph graph;
+    Utils::json2pb(graph, graph_str);
+
+    gbwt::FastLocate r_index(gbwt_index);
+    PathsIndex paths_index(gbwt_index, r_index, graph);
+
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search_1;
+    paths_index.find(&gbwt_search_1, gbwt::Node::encode(1, false));
+
+    pair<gbwt::SearchState, gbwt::size_type> gbwt_search_2;
+    paths_index.find(&gbwt_search_2, gbwt::Node::encode(2, false));
+
+    const pair<gbwt::SearchState, gbwt::size_type> gbwt_search_empty;
+
+    vector<AlignmentPath> align_paths_1({AlignmentPath(gbwt_search_1, true, 60, 10, 20, 100), AlignmentPath(gbwt_search_empty, false, 60, 0, 0, 0)});
+    vector<AlignmentPath> align_paths_2({AlignmentPath(gbwt_search_1, false, 60, 10, 20, 100), AlignmentPath(gbwt_search_2, false, 60, 10, 20, 100), AlignmentPath(gbwt_search_empty, false, 60, 0, 0, 0)});
+
+    AlignmentPathsIndex align_paths_index;
+    align_paths_index.add(align_paths_1, 1);
+
+    PathIdsIndex path_ids_index;
+    REQUIRE(path_ids_index.size() == 0);
+
+    path_ids_index.addAlignmentPaths(paths_index, align_paths_index, 2);
+    REQUIRE(path_ids_index.size() == 2);
+
+    align_paths_index.add(align_paths_2, 1);
+
+    path_ids_index.addAlignmentPaths(paths_index, align_paths_index, 2);
+    REQUIRE(path_ids_index.size() == 3);
+
+    REQUIRE(path_ids_index.pathIds(gbwt_search_1) == vector<gbwt::size_type>({0, 2}));
+    REQUIRE(path_ids_index.pathIds(gbwt_search_2) == vector<gbwt::size_type>({0, 1}));
+    REQUIRE(path_ids_index.pathIds(gbwt_search_empty).empty());
+
+    SECTION("Path ids can be released") {
+
+        path_ids_index.releasePathIds(gbwt_search_1);
+
+        REQUIRE(path_ids_index.size() == 3);
+        REQUIRE(path_ids_index.pathIds(gbwt_search_1).empty());
+        REQUIRE(path_ids_index.pathIds(gbwt_search_2) == vector<gbwt::size_type>({0, 1}));
+    }
+}
@@ -0,0 +1,150 @@
+
+#include "catch.hpp"
+
+#include <fstream>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "../path_info_parser.hpp"
+
+
+TEST_CASE("Path haplotype/transcript information can be parsed") {
+
+    const string info_filename = "path_info_parser_test.txt";
+
+    ofstream info_ostream(info_filename);
+    info_ostream << "Name\tLength\tTranscripts\tHaplotypes\n";
+    info_ostream << "path1\t10\ttrans1\thap1,hap2\n";
+    info_ostream << "path2\t10\ttrans2\thap2\n";
+    info_ostream << "path3\t12\ttrans1\thap3,hap1,hap4\n";
+    info_ostream << "path4\t5\ttrans3\thap4\n";
+    info_ostream << "path5\t7\ttrans2\thap5\n";
+    info_ostream.close();
+
+    PathInfoParser path_info_parser(1);
+
+    REQUIRE(path_info_parser.parseText(info_filename, true));
+    REQUIRE(path_info_parser.numberOfPaths() == 5);
+
+    auto path_info = [&](const PathInfoParser & parser, const string & path_name, const bool parse_haplotype_ids, const bool use_transcript_names) {
+
+        PathInfo info("");
+        REQUIRE(parser.pathInfo(&info, path_name, parse_haplotype_ids, use_transcript_names));
+
+        return info;
+    };
+
+    const vector<string> path_names({"path1", "path2", "path3", "path4", "path5"});
+
+    REQUIRE(path_info(path_info_parser, "path1", true, false).name == "path1");
+    REQUIRE(path_info(path_info_parser, "path1", true, false).group_id == 0);
+    REQUIRE(path_info(path_info_parser, "path1", true, false).source_count == 2);
+    REQUIRE(path_info(path_info_parser, "path1", true, false).source_ids == spp::sparse_hash_set<uint32_t>({0, 1}));
+
+    REQUIRE(path_info(path_info_parser, "path3", true, false).group_id == 0);
+    REQUIRE(path_info(path_info_parser, "path3", true, false).source_ids == spp::sparse_hash_set<uint32_t>({0, 2, 3}));
+
+    REQUIRE(path_info(path_info_parser, "path5", true, false).group_id == 1);
+    REQUIRE(path_info(path_info_parser, "path5", true, false).source_ids == spp::sparse_hash_set<uint32_t>({4}));
+
+    REQUIRE(path_info(path_info_parser, "path4", false, true).name == "trans3");
+    REQUIRE(path_info(path_info_parser, "path4", false, true).group_id == 2);
+    REQUIRE(path_info(path_info_parser, "path3", false, true).source_count == 3);
+    REQUIRE(path_info(path_info_parser, "path3", false, true).source_ids.empty());
+
+    PathInfo missing_path_info("");
+    REQUIRE(!path_info_parser.pathInfo(&missing_path_info, "path", true, false));
+    REQUIRE(!path_info_parser.pathInfo(&missing_path_info, "path6", true, false));
+
+    SECTION("Parallel parsing gives identical ids") {
+
+        PathInfoParser path_info_parser_par(3);
+        REQUIRE(path_info_parser_par.parseText(info_filename, true));
+        REQUIRE(path_info_parser_par.numberOfPaths() == 5);
+
+        for (auto & path_name: path_names) {
+
+            REQUIRE(path_info(path_info_parser_par, path_name, true, false).group_id == path_info(path_info_parser, path_name, true, false).group_id);
+            REQUIRE(path_info(path_info_parser_par, path_name, true, false).source_ids == path_info(path_info_parser, path_name, true, false).source_ids);
+        }
+    }
+
+    SECTION("Parsed information can be written to and loaded from binary file") {
+
+        path_info_parser.writeBinary(info_filename + ".bin", info_filename);
+
+        PathInfoParser path_info_parser_bin(1);
+        REQUIRE(path_info_parser_bin.loadBinary(info_filename + ".bin", info_filename));
+        REQUIRE(path_info_parser_bin.hasHaplotypeIds());
+        REQUIRE(path_info_parser_bin.numberOfPaths() == 5);
+
+        for (auto & path_name: path_names) {
+
+            REQUIRE(path_info(path_info_parser_bin, path_name, true, true).name == path_info(path_info_parser, path_name, false, true).name);
+            REQUIRE(path_info(path_info_parser_bin, path_name, true, true).group_id == path_info(path_info_parser, path_name, true, false).group_id);
+            REQUIRE(path_info(path_info_parser_bin, path_name, true, true).source_ids == path_info(path_info_parser, path_name, true, false).source_ids);
+        }
+
+        REQUIRE(!path_info_parser_bin.pathInfo(&missing_path_info, "path6", true, false));
+        REQUIRE(!path_info_parser_bin.loadBinary(info_filename + ".bin", info_filename + ".bin"));
+
+        SECTION("Binary file is not loaded after text file is modified") {
+
+            struct timespec modification_times[2];
+
+            modification_times[0].tv_sec = 0;
+            modification_times[0].tv_nsec = UTIME_OMIT;
+            modification_times[1].tv_sec = 1;
+            modification_times[1].tv_nsec = 0;
+
+            REQUIRE(utimensat(AT_FDCWD, info_filename.c_str(), modification_times, 0) == 0);
+            REQUIRE(!path_info_parser_bin.loadBinary(info_filename + ".bin", info_filename));
+        }
+
+        remove((info_filename + ".bin").c_str());
+    }
+
+    SECTION("Trailing empty haplotype name is counted but not given an id") {
+
+        const string trailing_info_filename = "path_info_parser_test_trailing.txt";
+
+        ofstream trailing_info_ostream(trailing_info_filename);
+        trailing_info_ostream << "Name\tLength\tTranscripts\tHaplotypes\n";
+        trailing_info_ostream << "path1\t10\ttrans1\thap1,hap2,\n";
+        trailing_info_ostream << "path2\t10\ttrans2\t\n";
+        trailing_info_ostream.close();
+
+        PathInfoParser path_info_parser_trailing(1);
+        REQUIRE(path_info_parser_trailing.parseText(trailing_info_filename, true));
+        REQUIRE(path_info_parser_trailing.numberOfPaths() == 2);
+
+        REQUIRE(path_info(path_info_parser_trailing, "path1", false, false).source_count == 3);
+        REQUIRE(path_info(path_info_parser_trailing, "path1", true, false).source_ids == spp::sparse_hash_set<uint32_t>({0, 1}));
+
+        REQUIRE(path_info(path_info_parser_trailing, "path2", false, false).source_count == 1);
+        REQUIRE(path_info(path_info_parser_trailing, "path2", true, false).source_ids.empty());
+
+        remove(trailing_info_filename.c_str());
+    }
+
+    SECTION("Duplicate path names are rejected") {
+
+        const string duplicate_info_filename = "path_info_parser_test_duplicate.txt";
+
+        ofstream duplicate_info_ostream(duplicate_info_filename);
+        duplicate_info_ostream << "Name\tLength\tTranscripts\tHaplotypes\n";
+        duplicate_info_ostream << "path1\t10\ttrans1\thap1\n";
+        duplicate_info_ostream << "path2\t10\ttrans2\thap2\n";
+        duplicate_info_ostream << "path1\t12\ttrans3\thap3\n";
+        duplicate_info_ostream.close();
+
+        PathInfoParser path_info_parser_duplicate(2);
+        REQUIRE(!path_info_parser_duplicate.parseText(duplicate_info_filename, true));
+        REQUIRE(path_info_parser_duplicate.numberOfPaths() == 0);
+
+        remove(duplicate_info_filename.c_str());
+    }
+
+    remove(info_filename.c_str());
+}
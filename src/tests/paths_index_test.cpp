@@ -64,6 +64,83 @@ TEST_CASE("Path index can calculate path lengths") {
     REQUIRE(paths_index.pathLength(0) == 38);
     REQUIRE(paths_index.pathLength(1) == 7);
 
+	SECTION("Node lengths can be serialized and loaded without graph") {
+
+        std::stringstream node_lengths_stream;
+        paths_index.serializeNodeLengths(node_lengths_stream);
+
+        PathsIndex paths_index_nl(gbwt_index, r_index, node_lengths_stream);
+
+        REQUIRE(paths_index_nl.numberOfNodes() == paths_index.numberOfNodes());
+        REQUIRE(!paths_index_nl.hasNodeId(0));
+
+        for (uint32_t i = 1; i < paths_index.numberOfNodes(); ++i) {
+
+            REQUIRE(paths_index_nl.hasNodeId(i));
+            REQUIRE(paths_index_nl.nodeLength(i) == paths_index.nodeLength(i));
+        }
+
+        REQUIRE(paths_index_nl.nodeLength(2) == 32);
+        REQUIRE(paths_index_nl.pathLength(0) == 38);
+    }
+
+	SECTION("Extended searches can be cached") {
+
+        GBWTSearchCache search_cache(4);
+
+        pair<gbwt::SearchState, gbwt::size_type> gbwt_search;
+        paths_index.find(&gbwt_search, gbwt::Node::encode(1, false));
+
+        auto extended_gbwt_search = gbwt_search;
+        paths_index.extend(&extended_gbwt_search, gbwt::Node::encode(2, false));
+
+        auto cached_gbwt_search = gbwt_search;
+        paths_index.extend(&cached_gbwt_search, gbwt::Node::encode(2, false), &search_cache);
+
+        REQUIRE(cached_gbwt_search == extended_gbwt_search);
+        REQUIRE(search_cache.lookups() == 1);
+        REQUIRE(search_cache.hits() == 0);
+
+        cached_gbwt_search = gbwt_search;
+        paths_index.extend(&cached_gbwt_search, gbwt::Node::encode(2, false), &search_cache);
+
+        REQUIRE(cached_gbwt_search == extended_gbwt_search);
+        REQUIRE(paths_index.locatePathIds(cached_gbwt_search) == vector<gbwt::size_type>({0}));
+        REQUIRE(search_cache.lookups() == 2);
+        REQUIRE(search_cache.hits() == 1);
+
+        cached_gbwt_search = gbwt_search;
+        paths_index.extend(&cached_gbwt_search, gbwt::Node::encode(3, false), &search_cache);
+
+        REQUIRE(paths_index.locatePathIds(cached_gbwt_search) == vector<gbwt::size_type>({1}));
+        REQUIRE(search_cache.lookups() == 3);
+        REQUIRE(search_cache.hits() == 1);
+	}
+
+	SECTION("Minimum distances to target nodes can be calculated") {
+
+        REQUIRE(!paths_index.hasPredecessorIndex());
+
+        paths_index.buildPredecessorIndex();
+        REQUIRE(paths_index.hasPredecessorIndex());
+
+        spp::sparse_hash_map<gbwt::node_type, uint32_t> target_distances;
+        paths_index.minTargetDistances(&target_distances, vector<gbwt::node_type>({gbwt::Node::encode(4, false)}), 10);
+
+        REQUIRE(target_distances.size() == 3);
+        REQUIRE(target_distances.at(gbwt::Node::encode(1, false)) == 1);
+        REQUIRE(target_distances.at(gbwt::Node::encode(2, false)) == 0);
+        REQUIRE(target_distances.at(gbwt::Node::encode(3, false)) == 0);
+
+        paths_index.minTargetDistances(&target_distances, vector<gbwt::node_type>({gbwt::Node::encode(4, false)}), 0);
+
+        REQUIRE(target_distances.size() == 2);
+        REQUIRE(target_distances.count(gbwt::Node::encode(1, false)) == 0);
+
+        paths_index.minTargetDistances(&target_distances, vector<gbwt::node_type>({gbwt::Node::encode(1, false)}), 10);
+        REQUIRE(target_distances.empty());
+	}
+
 	SECTION("Effective paths length are calculated using fragment length distribution") {
 
 		FragmentLengthDist fragment_length_dist(5, 2, 10);
@@ -0,0 +1,64 @@
+
+#include "catch.hpp"
+
+#include <sstream>
+
+#include "../read_stats.hpp"
+
+
+TEST_CASE("Read costs are added to histograms and most expensive reads") {
+
+    ReadStats read_stats(2);
+
+    ReadCosts read_costs;
+    read_costs.num_expanded_nodes = 5;
+    read_costs.num_extend_calls = 1;
+    read_costs.time = 0.5;
+
+    read_stats.add("read1", read_costs);
+
+    read_costs.num_expanded_nodes = 4;
+    read_costs.time = 0.25;
+
+    read_stats.add("read2", read_costs);
+
+    read_costs.num_expanded_nodes = 0;
+    read_costs.time = 1;
+
+    read_stats.add("read3", read_costs);
+
+    REQUIRE(read_stats.numReads() == 3);
+
+    REQUIRE(read_stats.histogram(0) == vector<uint64_t>({1, 0, 0, 2}));
+    REQUIRE(read_stats.histogram(1) == vector<uint64_t>({3}));
+    REQUIRE(read_stats.histogram(2) == vector<uint64_t>({0, 3}));
+
+    REQUIRE(read_stats.topReads().size() == 2);
+    REQUIRE(read_stats.topReads().front() == make_pair(0.5, string("read1")));
+
+    SECTION("Read statistics can be merged") {
+
+        ReadStats read_stats_2(2);
+
+        read_costs.num_expanded_nodes = 16;
+        read_costs.time = 2;
+
+        read_stats_2.add("read4", read_costs);
+        read_stats.merge(read_stats_2);
+
+        REQUIRE(read_stats.numReads() == 4);
+        REQUIRE(read_stats.histogram(0) == vector<uint64_t>({1, 0, 0, 2, 0, 1}));
+
+        REQUIRE(read_stats.topReads().size() == 2);
+        REQUIRE(read_stats.topReads().front() == make_pair(1.0, string("read3")));
+
+        stringstream report_stream;
+        read_stats.writeReport(report_stream);
+
+        const string report = report_stream.str();
+
+        REQUIRE(report.find("expanded_nodes\t16\t31\t1") != string::npos);
+        REQUIRE(report.find("read4\t2\nread3\t1\n") != string::npos);
+        REQUIRE(report.find("read1") == string::npos);
+    }
+}
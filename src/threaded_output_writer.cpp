@@ -5,22 +5,46 @@
 
 const uint32_t out_precision_digits = 8;
 
-ThreadedOutputWriter::ThreadedOutputWriter(const string & filename, const string & compression_mode, const uint32_t num_threads) {
+ThreadedOutputWriter::ThreadedOutputWriter(const string & filename_in, const string & compression_mode, const uint32_t num_threads) : filename(filename_in), has_write_error(false) {
 
     writer_stream = bgzf_open(filename.c_str(), compression_mode.c_str());
 
+    if (!writer_stream) {
+
+        throw runtime_error("Could not open output file (" + filename + ")");
+    }
+
     output_queue = new ProducerConsumerQueue<stringstream *>(num_threads * 5);
     writing_thread = thread(&ThreadedOutputWriter::write, this);
 }
 
+ThreadedOutputWriter::~ThreadedOutputWriter() {
+
+    // Output is not closed if an error occurred before close() was called.
+    if (writing_thread.joinable()) {
+
+        finish();
+    }
+}
+
 void ThreadedOutputWriter::close() {
 
+    if (!finish()) {
+
+        throw runtime_error("Could not write output file (" + filename + ")");
+    }
+}
+
+bool ThreadedOutputWriter::finish() {
+
+    assert(writing_thread.joinable());
     output_queue->pushedLast();
 
     writing_thread.join();
     delete output_queue;
 
-    assert(bgzf_close(writer_stream) == 0);
+    const int close_status = bgzf_close(writer_stream);
+    return (!has_write_error && close_status == 0);
 }
 
 void ThreadedOutputWriter::write() {
@@ -30,7 +54,12 @@ void ThreadedOutputWriter::write() {
     while (output_queue->pop(&out_sstream)) {
 
         const string & tmp_out_string = out_sstream->str();   
-        assert(bgzf_write(writer_stream, tmp_out_string.data(), tmp_out_string.size()) >= 0);
+
+        // Remaining output is still consumed after an error.
+        if (!has_write_error && bgzf_write(writer_stream, tmp_out_string.data(), tmp_out_string.size()) < 0) {
+
+            has_write_error = true;
+        }
 
         delete out_sstream;
     }
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <stdexcept>
 
 #include "htslib/bgzf.h"
 #include "htslib/hts.h"
@@ -16,12 +17,14 @@
 
 using namespace std;
 
+// Writes output in a separate thread. Throws runtime_error if the file 
+// can not be opened, or from close() if the output could not be written.
 class ThreadedOutputWriter {
 
     public: 
 
-        ThreadedOutputWriter(const string & filename, const string & compression_mode, const uint32_t num_threads);
-        virtual ~ThreadedOutputWriter() {};
+        ThreadedOutputWriter(const string & filename_in, const string & compression_mode, const uint32_t num_threads);
+        virtual ~ThreadedOutputWriter();
 
         void close();
 
@@ -31,10 +34,15 @@ class ThreadedOutputWriter {
 
     private:
 
+        const string filename;
+
         BGZF * writer_stream;
         thread writing_thread; 
 
+        bool has_write_error;
+
         void write();
+        bool finish();
 };
 
 class ProbabilityClusterWriter : public ThreadedOutputWriter {
@@ -336,19 +336,46 @@ namespace Utils {
         return buffer;
     }
 
-    // Note that edit sequences are not reverse complemented.
+    // Returns element at index in repeated message field. The element is added if 
+    // the field is too short, otherwise the previously allocated message is reused.
+    template<typename MessageType>
+    inline MessageType* reuse_repeated_element(google::protobuf::RepeatedPtrField<MessageType>* repeated_field, const int index) {
+
+        assert(index <= repeated_field->size());
+
+        if (index < repeated_field->size()) {
+
+            return repeated_field->Mutable(index);
+        } 
+
+        return repeated_field->Add();
+    }
+
+    // Removes elements after the first size elements. Removed messages are 
+    // kept by the field for reuse.
+    template<typename MessageType>
+    inline void truncate_repeated_field(google::protobuf::RepeatedPtrField<MessageType>* repeated_field, const int size) {
+
+        while (repeated_field->size() > size) {
+
+            repeated_field->RemoveLast();
+        }
+    }
+
+    // Note that edit sequences are not reverse complemented. The reversed mapping is 
+    // written to mapping_rc, which reuses its allocated memory. 
     // Original function in vg repo: reverse_complement_mapping().
-    inline vg::Mapping lazy_reverse_complement_mapping(const vg::Mapping& mapping,
-                                       const function<int64_t(int64_t)> & node_length) {
+    inline void lazy_reverse_complement_mapping(const vg::Mapping& mapping,
+                                       const function<int64_t(int64_t)> & node_length, vg::Mapping* mapping_rc) {
         // Make a new reversed mapping
-        vg::Mapping mapping_rc;
-        *mapping_rc.mutable_position() = mapping.position();
+        *mapping_rc->mutable_position() = mapping.position();
+        mapping_rc->clear_edit();
 
         // switching around to the reverse strand requires us to change offsets
         // that are nonzero to count the unused bases on the other side of the block
         // of used bases.
         if(mapping.has_position() && mapping.position().node_id() != 0) {
-            vg::Position* p = mapping_rc.mutable_position();
+            vg::Position* p = mapping_rc->mutable_position();
             
             // How many node bases are used by the mapping?
             size_t used_bases = mapping_from_length(mapping);
@@ -365,73 +392,91 @@ namespace Utils {
 
         for (int64_t i = mapping.edit_size() - 1; i >= 0; i--) {
             // For each edit in reverse order, put it in reverse complemented
-            *mapping_rc.add_edit() = mapping.edit(i);
+            *mapping_rc->add_edit() = mapping.edit(i);
         }
+    }
+
+    inline vg::Mapping lazy_reverse_complement_mapping(const vg::Mapping& mapping,
+                                       const function<int64_t(int64_t)> & node_length) {
+
+        vg::Mapping mapping_rc;
+        lazy_reverse_complement_mapping(mapping, node_length, &mapping_rc);
 
         return mapping_rc;
     }
 
     // Reverse complements path. Note that edit sequences are not reverse complemented. 
     // Original function in vg repo: reverse_complement_path().
-    inline vg::Path lazy_reverse_complement_path(const vg::Path& path,
-                                 const function<int64_t(int64_t)> & node_length) {
-
-        vg::Path path_rc;
+    inline void lazy_reverse_complement_path(const vg::Path& path,
+                                 const function<int64_t(int64_t)> & node_length, vg::Path* path_rc) {
 
         for(int64_t i = path.mapping_size() - 1; i >= 0; i--) {
             // For each mapping in reverse order, put it in reverse complemented and
             // measured from the other end of the node.
-            *path_rc.add_mapping() = lazy_reverse_complement_mapping(path.mapping(i), node_length);
+            lazy_reverse_complement_mapping(path.mapping(i), node_length, reuse_repeated_element(path_rc->mutable_mapping(), path.mapping_size() - i - 1));
         }
 
+        truncate_repeated_field(path_rc->mutable_mapping(), path.mapping_size());
+    }
+
+    inline vg::Path lazy_reverse_complement_path(const vg::Path& path,
+                                 const function<int64_t(int64_t)> & node_length) {
+
+        vg::Path path_rc;
+        lazy_reverse_complement_path(path, node_length, &path_rc);
+
         return path_rc;
     }
 
     // Reverse complements alignment. Note that sequences, paths and edit sequences 
-    // are not reverse complemented. Original function in vg repo: reverse_complement_alignment().
-    inline vg::Alignment lazy_reverse_complement_alignment(const vg::Alignment& aln,
-                                           const function<int64_t(int64_t)>& node_length) {
+    // are not reverse complemented. The fields of aln_rc are overwritten in place, 
+    // so reusing it between alignments avoids most allocations.
+    // Original function in vg repo: reverse_complement_alignment().
+    inline void lazy_reverse_complement_alignment(const vg::Alignment& aln,
+                                           const function<int64_t(int64_t)>& node_length, vg::Alignment* aln_rc) {
         // We're going to reverse the alignment and all its mappings.
-        // TODO: should we/can we do this in place?
-        
-        vg::Alignment aln_rc;
+        aln_rc->mutable_sequence()->assign(aln.sequence().rbegin(), aln.sequence().rend());
+        aln_rc->mutable_quality()->assign(aln.quality().rbegin(), aln.quality().rend());
+
+        aln_rc->set_score(aln.score());
+        aln_rc->set_mapping_quality(aln.mapping_quality());
 
-        aln_rc.set_sequence(string(aln.sequence().rbegin(), aln.sequence().rend()));
-        aln_rc.set_quality(string(aln.quality().rbegin(), aln.quality().rend()));
+        lazy_reverse_complement_path(aln.path(), node_length, aln_rc->mutable_path());
+    }
 
-        aln_rc.set_score(aln.score());
-        aln_rc.set_mapping_quality(aln.mapping_quality());
+    inline vg::Alignment lazy_reverse_complement_alignment(const vg::Alignment& aln,
+                                           const function<int64_t(int64_t)>& node_length) {
 
-        *aln_rc.mutable_path() = lazy_reverse_complement_path(aln.path(), node_length);
+        vg::Alignment aln_rc;
+        lazy_reverse_complement_alignment(aln, node_length, &aln_rc);
         
         return aln_rc;
     }
 
     // Reverse complements multipath alignment. Note that sequences, paths and edit sequences 
-    // are not reverse complemented. Original name in vg repo: rev_comp_multipath_alignment().
-    inline vg::MultipathAlignment lazy_reverse_complement_alignment(const vg::MultipathAlignment& multipath_aln, const function<int64_t(int64_t)>& node_length) {
+    // are not reverse complemented. The fields of multipath_aln_rc are overwritten in 
+    // place. Original name in vg repo: rev_comp_multipath_alignment().
+    inline void lazy_reverse_complement_alignment(const vg::MultipathAlignment& multipath_aln, const function<int64_t(int64_t)>& node_length, vg::MultipathAlignment* multipath_aln_rc) {
         
-        vg::MultipathAlignment multipath_aln_rc;
+        multipath_aln_rc->mutable_sequence()->assign(multipath_aln.sequence().rbegin(), multipath_aln.sequence().rend());
+        multipath_aln_rc->mutable_quality()->assign(multipath_aln.quality().rbegin(), multipath_aln.quality().rend());
 
-        multipath_aln_rc.set_sequence(string(multipath_aln.sequence().rbegin(), multipath_aln.sequence().rend()));
-        multipath_aln_rc.set_quality(string(multipath_aln.quality().rbegin(), multipath_aln.quality().rend()));
-
-        multipath_aln_rc.set_mapping_quality(multipath_aln.mapping_quality());
+        multipath_aln_rc->set_mapping_quality(multipath_aln.mapping_quality());
 
         vector<vector<size_t> > reverse_edge_lists(multipath_aln.subpath_size());
         vector<vector<pair<size_t, int32_t> > > reverse_connection_lists(multipath_aln.subpath_size());
 
         vector<size_t> reverse_starts;
         
-        // remove subpaths to avoid duplicating
-        // multipath_aln_rc.clear_subpath();
-        
         // add subpaths in reverse order to maintain topological ordering
         for (int64_t i = multipath_aln.subpath_size() - 1; i >= 0; i--) {
             const vg::Subpath& subpath = multipath_aln.subpath(i);
-            vg::Subpath* rc_subpath = multipath_aln_rc.add_subpath();
+            vg::Subpath* rc_subpath = reuse_repeated_element(multipath_aln_rc->mutable_subpath(), multipath_aln.subpath_size() - i - 1);
+
+            rc_subpath->clear_next();
+            rc_subpath->clear_connection();
             
-            *(rc_subpath->mutable_path()) = lazy_reverse_complement_path(subpath.path(), node_length);
+            lazy_reverse_complement_path(subpath.path(), node_length, rc_subpath->mutable_path());
             rc_subpath->set_score(subpath.score());
 
             if (subpath.next_size() > 0 || subpath.connection_size() > 0) {
@@ -449,9 +494,11 @@ namespace Utils {
             }
         }
         
+        truncate_repeated_field(multipath_aln_rc->mutable_subpath(), multipath_aln.subpath_size());
+
         // add reversed edges
         for (size_t i = 0; i < multipath_aln.subpath_size(); i++) {
-            vg::Subpath* rc_subpath = multipath_aln_rc.mutable_subpath(i);
+            vg::Subpath* rc_subpath = multipath_aln_rc->mutable_subpath(i);
             vector<size_t>& reverse_edge_list = reverse_edge_lists[multipath_aln.subpath_size() - i - 1];
             for (size_t j = 0; j < reverse_edge_list.size(); j++) {
                 rc_subpath->add_next(multipath_aln.subpath_size() - reverse_edge_list[j] - 1);
@@ -464,16 +511,21 @@ namespace Utils {
             }
         }
         
-        // remove start nodes that are invalid in reverse
-        // multipath_aln_rc.clear_start();
-        
+        multipath_aln_rc->clear_start();
+
         // assume that if the original multipath alignment had its starts labeled they want them
         // labeled in the reverse complement too
         if (multipath_aln.start_size() > 0) {
             for (size_t i = 0; i < reverse_starts.size(); i++) {
-                multipath_aln_rc.add_start(multipath_aln.subpath_size() - reverse_starts[i] - 1);
+                multipath_aln_rc->add_start(multipath_aln.subpath_size() - reverse_starts[i] - 1);
             }
         }
+    }
+
+    inline vg::MultipathAlignment lazy_reverse_complement_alignment(const vg::MultipathAlignment& multipath_aln, const function<int64_t(int64_t)>& node_length) {
+
+        vg::MultipathAlignment multipath_aln_rc;
+        lazy_reverse_complement_alignment(multipath_aln, node_length, &multipath_aln_rc);
 
         return multipath_aln_rc;
     }